@@ -0,0 +1,142 @@
+"""Generates the display action tables from actions.json.
+
+actions.json is the single definition of the control-panel actions: list
+order is button order, and each entry has
+
+    op       stable opcode sent by the display (1-255, never reused)
+    name     job name reported back to the display (< 16 chars)
+    label    button text
+    color    button color, RRGGBB
+    confirm  ask on the display before sending
+    run      command the bridge runs; "{scripts}" expands to "scripts"
+
+Outputs (checked in, so the bridge runs without this script):
+
+    LCD/lib/TravelProto/TravelActions.h   firmware table
+    LCD/bridge/actions.py                 bridge table
+
+Run by hand after editing actions.json (--check only reports stale
+outputs); PlatformIO also runs it before every firmware build through
+extra_scripts.
+"""
+import json
+import os
+import re
+import sys
+
+try:
+    Import("env")  # noqa: F821 - defined when run by PlatformIO (SCons)
+    LCD_DIR = os.path.normpath(os.path.join(env.subst("$PROJECT_DIR"), ".."))  # noqa: F821
+except NameError:
+    LCD_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+SCHEMA = os.path.join(LCD_DIR, "actions", "actions.json")
+HEADER = os.path.join(LCD_DIR, "lib", "TravelProto", "TravelActions.h")
+MODULE = os.path.join(LCD_DIR, "bridge", "actions.py")
+
+NAME_MAX = 15  # TP_ACTION_LEN - 1
+
+
+def load():
+    with open(SCHEMA) as f:
+        schema = json.load(f)
+    actions = schema["actions"]
+    ops, names = set(), set()
+    for a in actions:
+        if not 1 <= a["op"] <= 255 or a["op"] in ops:
+            raise ValueError(f"{a['name']}: opcode {a['op']} out of range or reused")
+        if not re.fullmatch(r"[a-z0-9_]{1,%d}" % NAME_MAX, a["name"]) or a["name"] in names:
+            raise ValueError(f"{a['name']}: bad or duplicate name")
+        ops.add(a["op"])
+        names.add(a["name"])
+        a["run"] = [arg.replace("{scripts}", schema["scripts"]) for arg in a["run"]]
+    return actions
+
+
+def rgb565(color):
+    rgb = int(color, 16)
+    r, g, b = rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+def c_string(s):
+    return json.dumps(s)  # same escapes as C for the ASCII we allow
+
+
+def header(actions):
+    out = [
+        "// GENERATED from LCD/actions/actions.json by gen_actions.py; do not edit.",
+        "#pragma once",
+        "",
+        '#include "TravelProto.h"',
+        "",
+        "enum tp_opcode : uint8_t {",
+    ]
+    out += [f"  TP_OP_{a['name'].upper()} = {a['op']}," for a in actions]
+    out += [
+        "};",
+        "",
+        f"#define TP_ACTION_COUNT {len(actions)}",
+        "",
+        "// In button order",
+        "static const tp_action tp_actions[TP_ACTION_COUNT] = {",
+    ]
+    for a in actions:
+        out.append(f"    {{TP_OP_{a['name'].upper()}, {c_string(a['name'])}, {c_string(a['label'])}, "
+                   f"0x{int(a['color'], 16):06X}, 0x{rgb565(a['color']):04X}, "
+                   f"{'true' if a['confirm'] else 'false'}}},")
+    out += ["};", ""]
+    return "\n".join(out)
+
+
+def module(actions):
+    out = [
+        '"""Display actions, by opcode and by name.',
+        "",
+        "GENERATED from LCD/actions/actions.json by gen_actions.py; do not edit.",
+        '"""',
+        "import collections",
+        "",
+        'Action = collections.namedtuple("Action", "op name label argv confirm")',
+        "",
+        "# In button order",
+        "ACTIONS = (",
+    ]
+    for a in actions:
+        out.append(f"    Action({a['op']}, {a['name']!r}, {a['label']!r}, {tuple(a['run'])!r}, {a['confirm']!r}),")
+    out += [
+        ")",
+        "",
+        "BY_OP = {a.op: a for a in ACTIONS}",
+        "BY_NAME = {a.name: a for a in ACTIONS}",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def generate(check=False):
+    """Write outputs that differ from the schema; returns the stale paths."""
+    actions = load()
+    stale = []
+    for path, text in ((HEADER, header(actions)), (MODULE, module(actions))):
+        try:
+            with open(path) as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != text:
+            stale.append(path)
+            if not check:
+                with open(path, "w") as f:
+                    f.write(text)
+    return stale
+
+
+if __name__ == "__main__":
+    check = "--check" in sys.argv[1:]
+    stale = generate(check)
+    for path in stale:
+        print(f"{'stale' if check else 'wrote'}: {os.path.relpath(path, LCD_DIR)}")
+    sys.exit(1 if check and stale else 0)
+else:
+    generate()
@@ -0,0 +1,21 @@
+"""Display actions, by opcode and by name.
+
+GENERATED from LCD/actions/actions.json by gen_actions.py; do not edit.
+"""
+import collections
+
+Action = collections.namedtuple("Action", "op name label argv confirm")
+
+# In button order
+ACTIONS = (
+    Action(1, 'reset_network', 'Reset Net', ('sudo', '/home/raltmeyer/pi4-travelserver/scripts/full_network_reset.sh'), True),
+    Action(2, 'fw_strict', 'FW Strict', ('sudo', '/home/raltmeyer/pi4-travelserver/scripts/firewall_strict.sh'), True),
+    Action(3, 'fw_maint', 'FW Maint', ('sudo', '/home/raltmeyer/pi4-travelserver/scripts/firewall_maintenance.sh'), True),
+    Action(4, 'start_smb', 'Start SMB', ('sudo', '/home/raltmeyer/pi4-travelserver/scripts/start_fileserver.sh'), True),
+    Action(5, 'stop_smb', 'Stop SMB', ('sudo', '/home/raltmeyer/pi4-travelserver/scripts/stop_fileserver.sh'), True),
+    Action(6, 'reboot', 'Reboot', ('sudo', 'reboot'), True),
+    Action(7, 'shutdown', 'Shutdown', ('sudo', 'shutdown', '-h', 'now'), True),
+)
+
+BY_OP = {a.op: a for a in ACTIONS}
+BY_NAME = {a.name: a for a in ACTIONS}
@@ -0,0 +1,142 @@
+"""Cached metric collectors for SystemMonitor.
+
+Each metric is read by its own Collector on its own interval; telemetry
+frames are built from the cached values, so a slow source (disk, sensors)
+is paid for once a minute instead of on every frame. Every collector
+tracks the CPU time it has used so the cost of monitoring stays visible.
+"""
+import socket
+import time
+
+# rtnetlink multicast groups (linux/rtnetlink.h)
+RTMGRP_LINK = 0x1
+RTMGRP_IPV4_IFADDR = 0x10
+
+PROC_NET_DEV = "/proc/net/dev"
+
+
+class Collector:
+    """One metric: a read function, its cached value and what it costs.
+
+    interval is in seconds; None means the value is only refreshed when
+    refresh() is called (event-driven or read once).
+    """
+
+    def __init__(self, name, read, interval):
+        self.name = name
+        self.read = read
+        self.interval = interval
+        self.value = None
+        self.runs = 0
+        self.cpu_time = 0.0  # seconds of this thread's CPU spent in read()
+
+    def refresh(self):
+        start = time.thread_time()
+        try:
+            self.value = self.read()
+        except Exception as e:
+            print(f"Collector {self.name} failed: {e}")
+        self.cpu_time += time.thread_time() - start
+        self.runs += 1
+        return self.value
+
+    def schedule(self, loop):
+        """Refresh now and then every interval on the event loop."""
+        self.refresh()
+        if self.interval is not None:
+            loop.call_later(self.interval, lambda: self.schedule(loop))
+
+    def cost(self):
+        """(runs, total ms, average ms per run)"""
+        total = self.cpu_time * 1000
+        return self.runs, total, total / self.runs if self.runs else 0.0
+
+
+def open_address_watch():
+    """Non-blocking rtnetlink socket that becomes readable whenever a link
+    or IPv4 address changes, or None where netlink is unavailable."""
+    try:
+        sock = socket.socket(socket.AF_NETLINK, socket.SOCK_RAW | socket.SOCK_NONBLOCK,
+                             socket.NETLINK_ROUTE)
+        sock.bind((0, RTMGRP_LINK | RTMGRP_IPV4_IFADDR))
+        return sock
+    except (AttributeError, OSError):
+        return None
+
+
+def drain(sock):
+    """Discard pending netlink messages; the content doesn't matter, only
+    that something changed."""
+    try:
+        while sock.recv(65536):
+            pass
+    except (BlockingIOError, InterruptedError):
+        pass
+
+
+def read_net_dev(path=PROC_NET_DEV):
+    """{iface: (rx_bytes, rx_drops, tx_bytes, tx_drops)} from one read of
+    /proc/net/dev. Drops count errors too: either way the packet is lost."""
+    counters = {}
+    with open(path) as f:
+        for line in f.readlines()[2:]:  # two header lines
+            name, _, data = line.partition(":")
+            v = data.split()
+            if len(v) < 16:
+                continue
+            counters[name.strip()] = (int(v[0]), int(v[2]) + int(v[3]),
+                                      int(v[8]), int(v[10]) + int(v[11]))
+    return counters
+
+
+def counter_delta(new, old):
+    """Increase of a kernel counter, or None if it was reset.
+
+    32-bit kernels keep 32-bit counters that wrap every 4 GiB, which a busy
+    uplink reaches in minutes. A decrease that is small modulo 2^32 is a
+    wrap; anything else means the interface was re-created."""
+    if new >= old:
+        return new - old
+    wrapped = new - old + (1 << 32)
+    return wrapped if 0 <= wrapped < 1 << 31 else None
+
+
+class NetRates:
+    """Per-interface rx/tx bytes/s and drops/s from /proc/net/dev counter
+    deltas between consecutive read() calls."""
+
+    def __init__(self, path=PROC_NET_DEV):
+        self.path = path
+        self.last = {}
+        self.last_time = None
+
+    def read(self):
+        """{iface: {"rx": B/s, "tx": B/s, "drops": /s}}; empty on the first
+        call. An interface shows up one call after it appears."""
+        now = time.monotonic()
+        counters = read_net_dev(self.path)
+        rates = {}
+        if self.last_time is not None and now > self.last_time:
+            dt = now - self.last_time
+            for iface, new in counters.items():
+                old = self.last.get(iface)
+                if old is None:
+                    continue
+                deltas = [counter_delta(n, o) for n, o in zip(new, old)]
+                if None in deltas:
+                    continue
+                rx, rx_drops, tx, tx_drops = deltas
+                rates[iface] = {"rx": int(rx / dt), "tx": int(tx / dt),
+                                "drops": round((rx_drops + tx_drops) / dt, 1)}
+        self.last, self.last_time = counters, now
+        return rates
+
+
+def sum_rates(rates, ifaces):
+    """Combined rates of the listed interfaces (those that are down count 0)."""
+    total = {"rx": 0, "tx": 0, "drops": 0.0}
+    for iface in ifaces:
+        for key, value in rates.get(iface, {}).items():
+            total[key] += value
+    total["drops"] = round(total["drops"], 1)
+    return total
@@ -0,0 +1,101 @@
+"""Single-threaded event loop: readable file descriptors plus timers.
+
+Built on selectors (epoll on Linux). Callbacks run on the loop's thread,
+one at a time, so they can share state without locks. A callback must
+not block; hand slow work to a thread.
+"""
+import collections
+import heapq
+import itertools
+import os
+import selectors
+import threading
+import time
+
+
+class Timer:
+    def __init__(self, when, callback):
+        self.when = when
+        self.callback = callback
+        self.cancelled = False
+
+    def cancel(self):
+        self.cancelled = True
+
+
+class EventLoop:
+    def __init__(self):
+        self.selector = selectors.DefaultSelector()
+        self.timers = []  # heap of (when, seq, Timer)
+        self.seq = itertools.count()
+        self.running = False
+        # Wakeup pipe for callbacks posted from other threads
+        self.pending = collections.deque()
+        self.pending_lock = threading.Lock()
+        self.wake_r, self.wake_w = os.pipe()
+        os.set_blocking(self.wake_r, False)
+        os.set_blocking(self.wake_w, False)
+        self.selector.register(self.wake_r, selectors.EVENT_READ, self._run_pending)
+
+    def add_reader(self, fileobj, callback):
+        self.selector.register(fileobj, selectors.EVENT_READ, callback)
+
+    def remove_reader(self, fileobj):
+        try:
+            self.selector.unregister(fileobj)
+        except (KeyError, ValueError):
+            pass  # already gone (closed or never registered)
+
+    def call_later(self, delay, callback):
+        return self.call_at(time.monotonic() + delay, callback)
+
+    def call_at(self, when, callback):
+        timer = Timer(when, callback)
+        heapq.heappush(self.timers, (when, next(self.seq), timer))
+        return timer
+
+    def call_soon_threadsafe(self, callback):
+        """Run callback on the loop thread; callable from any thread."""
+        with self.pending_lock:
+            self.pending.append(callback)
+        try:
+            os.write(self.wake_w, b'\0')
+        except BlockingIOError:
+            pass  # pipe full: a wakeup is already pending
+
+    def _run_pending(self):
+        try:
+            while os.read(self.wake_r, 512):
+                pass
+        except BlockingIOError:
+            pass
+        while True:
+            with self.pending_lock:
+                if not self.pending:
+                    return
+                callback = self.pending.popleft()
+            callback()
+
+    def stop(self):
+        self.running = False
+
+    def run(self):
+        self.running = True
+        while self.running:
+            timeout = None
+            while self.timers and self.timers[0][2].cancelled:
+                heapq.heappop(self.timers)
+            if self.timers:
+                timeout = max(0, self.timers[0][0] - time.monotonic())
+
+            # select() with no registered fds still sleeps for the timeout
+            for key, _events in self.selector.select(timeout):
+                key.data()
+                if not self.running:
+                    return
+
+            now = time.monotonic()
+            while self.running and self.timers and self.timers[0][0] <= now:
+                _when, _seq, timer = heapq.heappop(self.timers)
+                if not timer.cancelled:
+                    timer.callback()
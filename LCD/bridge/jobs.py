@@ -0,0 +1,90 @@
+"""Runs display commands as background jobs.
+
+Every accepted command gets an ID and its progress is reported through
+notify(job, state) on the event loop thread:
+
+    accepted   queued behind MAX_JOBS running jobs (or about to start)
+    running    the script has started
+    done       finished; job.rc and job.duration are set
+    duplicate  the same action is already queued or running (job is that one)
+    rejected   unknown action (job.id is 0)
+"""
+import collections
+import itertools
+import subprocess
+import threading
+import time
+
+
+class Job:
+    def __init__(self, job_id, action, argv):
+        self.id = job_id
+        self.action = action
+        self.argv = argv
+        self.rc = None
+        self.duration = None  # seconds
+
+
+class JobExecutor:
+    def __init__(self, loop, actions, notify, max_jobs, timeout):
+        self.loop = loop
+        self.actions = actions  # action name -> argv
+        self.notify = notify
+        self.max_jobs = max_jobs
+        self.timeout = timeout
+        self.ids = itertools.count(1)
+        self.active = {}  # action -> queued or running Job
+        self.queue = collections.deque()
+        self.running = 0
+
+    def submit(self, action):
+        if action not in self.actions:
+            self.notify(Job(0, action, None), "rejected")
+            return
+        if action in self.active:
+            # Double tap: report the job already in flight instead
+            self.notify(self.active[action], "duplicate")
+            return
+        # IDs are 16-bit on the display; 0 is reserved for "no job"
+        job = Job((next(self.ids) - 1) % 0xFFFF + 1, action, self.actions[action])
+        self.active[action] = job
+        self.queue.append(job)
+        self.notify(job, "accepted")
+        self._start_next()
+
+    def _start_next(self):
+        while self.queue and self.running < self.max_jobs:
+            job = self.queue.popleft()
+            self.running += 1
+            self.notify(job, "running")
+            threading.Thread(target=self._run, args=(job,), daemon=True).start()
+
+    def _run(self, job):
+        # Worker thread: only the result goes back to the loop
+        start = time.monotonic()
+        try:
+            rc = subprocess.run(job.argv, timeout=self.timeout).returncode
+        except subprocess.TimeoutExpired:
+            rc = -1
+        except OSError as e:
+            print(f"Job {job.id} ({job.action}) failed to start: {e}")
+            rc = -2
+        duration = time.monotonic() - start
+        self.loop.call_soon_threadsafe(lambda: self._finished(job, rc, duration))
+
+    def _finished(self, job, rc, duration):
+        job.rc = rc
+        job.duration = duration
+        self.running -= 1
+        del self.active[job.action]
+        self.notify(job, "done")
+        self._start_next()
+
+
+def job_message(job, state):
+    """JSON-able {"job": {...}} line for the display."""
+    msg = {"id": job.id, "action": job.action, "state": state}
+    if state == "done":
+        msg["rc"] = job.rc
+        msg["ms"] = int(job.duration * 1000)
+    return {"job": msg}
@@ -0,0 +1,186 @@
+"""End-to-end latency tracing between the bridge and the display.
+
+When both hellos carry "trace": 1, every binary telemetry frame is preceded
+by a MSG_STAMP frame and the display acknowledges it once it is on screen:
+
+    bridge  -> MSG_STAMP [seq u16][sent u32]
+    bridge  -> MSG_TELEMETRY / MSG_TELEMETRY_DELTA
+    display -> MSG_ACK   [seq u16][sent u32][rx u32][done u32][status u8]
+
+sent is the bridge's monotonic clock, rx and done the display's micros()
+when it decoded the frame and when the panel update showing it was flushed;
+all are microseconds wrapping at 2^32. The display sends the ack right
+after done, so of the round trip, done - rx was spent on the display and
+the rest on the wire, half each way. That gives
+
+    telemetry -> panel = wire / 2 + (done - rx)
+
+and maps the display's clock onto ours, which dates the tap carried by
+every command (MSG_COMMAND [opcode u8][tap u32], or "t" in JSON):
+
+    tap -> command = arrival at handle_command - tap
+
+Frames not acknowledged within ACK_TIMEOUT count as lost (either
+direction); an ack older than the newest one seen counts as reordered.
+Keep in sync with LCD/lib/TravelProto/TravelProto.h (LATENCY TRACE).
+"""
+import bisect
+import struct
+import time
+from collections import deque
+
+import protocol
+
+STAMP = struct.Struct('<HI')
+ACK = struct.Struct('<HIIIB')
+ACK_DRAWN, ACK_UNCHANGED, ACK_SUPERSEDED = 0, 1, 2
+
+ACK_TIMEOUT = 5.0     # seconds before an unacknowledged frame counts as lost
+OFFSET_SAMPLES = 16   # recent acks the clock offset is picked from
+MAX_TAP_AGE = 60000   # ms; older taps mean the clock offset is stale
+
+# Histogram bucket upper bounds in ms; the last bucket is open-ended
+BUCKETS = (1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000)
+
+MASK = 0xFFFFFFFF
+
+
+def now_us():
+    return int(time.monotonic() * 1e6) & MASK
+
+
+def since_us(start, end):
+    """end - start on the wrapping clock, signed."""
+    d = (end - start) & MASK
+    return d - (1 << 32) if d & 0x80000000 else d
+
+
+class Histogram:
+    """Counts per BUCKETS bucket, plus count, sum and maximum."""
+
+    def __init__(self, bounds=BUCKETS):
+        self.bounds = bounds
+        self.counts = [0] * (len(bounds) + 1)
+        self.n = 0
+        self.total = 0.0
+        self.max = 0.0
+
+    def add(self, ms):
+        self.counts[bisect.bisect_left(self.bounds, ms)] += 1
+        self.n += 1
+        self.total += ms
+        self.max = max(self.max, ms)
+
+    def percentile(self, p):
+        """Upper bound of the bucket holding the nearest-rank percentile
+        (None: beyond the last bound)."""
+        rank = max(1, -(-self.n * p // 100))
+        seen = 0
+        for i, count in enumerate(self.counts):
+            seen += count
+            if seen >= rank:
+                return self.bounds[i] if i < len(self.bounds) else None
+        return None
+
+    def format(self):
+        if not self.n:
+            return "no samples"
+        def bound(p):
+            b = self.percentile(p)
+            return f"<={b}" if b is not None else f">{self.bounds[-1]}"
+        return (f"n={self.n} avg {self.total / self.n:.1f} max {self.max:.1f} "
+                f"p50 {bound(50)} p95 {bound(95)} p99 {bound(99)} ms")
+
+
+class LatencyTrace:
+    """Stamps outgoing telemetry and turns the display's acks and command
+    taps into histograms. Everything runs on the bridge's event loop."""
+
+    def __init__(self):
+        self.photon = Histogram()  # telemetry sent -> update on the panel
+        self.tap = Histogram()     # touch on the display -> handle_command
+        self.sent = self.acked = self.lost = self.late = 0
+        self.reordered = self.unchanged = self.superseded = 0
+        self.seq = 0  # keeps counting across sessions: no stale ack matches
+        self.reset()
+
+    def reset(self):
+        """New display session (hello): the display's clock may have
+        restarted. Frames still in flight are forgotten, not counted as lost."""
+        self.outstanding = {}  # seq -> monotonic send time, oldest first
+        self.expired = deque(maxlen=64)  # recently lost seqs, for late acks
+        self.newest = None  # newest acknowledged seq
+        self.offsets = deque(maxlen=OFFSET_SAMPLES)  # (wire us, display->bridge offset)
+
+    def stamp(self):
+        """MSG_STAMP frame for the telemetry frame about to be sent."""
+        self.expire()
+        seq, self.seq = self.seq, (self.seq + 1) & 0xFFFF
+        self.outstanding[seq] = time.monotonic()
+        self.sent += 1
+        return protocol.encode_frame(protocol.MSG_STAMP, STAMP.pack(seq, now_us()))
+
+    def expire(self):
+        deadline = time.monotonic() - ACK_TIMEOUT
+        for seq, sent in list(self.outstanding.items()):
+            if sent > deadline:
+                break
+            del self.outstanding[seq]
+            self.expired.append(seq)
+            self.lost += 1
+
+    def on_ack(self, payload):
+        """MSG_ACK from the display. Returns the telemetry -> panel latency
+        in ms, or None if this ack has none."""
+        if len(payload) < ACK.size:
+            return None
+        now = now_us()
+        seq, sent, rx, done, status = ACK.unpack_from(payload)
+        if self.outstanding.pop(seq, None) is None:
+            if seq not in self.expired:
+                return None  # duplicate, or from before the last hello
+            self.expired.remove(seq)
+            self.lost -= 1
+            self.late += 1
+        self.acked += 1
+        if self.newest is not None and (seq - self.newest) & 0x8000:
+            self.reordered += 1
+        else:
+            self.newest = seq
+
+        held = since_us(rx, done)   # on the display
+        wire = since_us(sent, now) - held
+        if held < 0 or wire < 0:
+            return None  # clock wrapped mid-flight, or a bogus ack
+        # The ack left right after done: half the wire time ago
+        self.offsets.append((wire, (now - wire // 2 - done) & MASK))
+
+        if status == ACK_SUPERSEDED:
+            self.superseded += 1
+            return None
+        if status == ACK_UNCHANGED:
+            self.unchanged += 1
+            return None
+        ms = (wire / 2 + held) / 1000
+        self.photon.add(ms)
+        return ms
+
+    def on_command(self, tap):
+        """Command tapped at display time tap (None: not sent) reached
+        handle_command. Returns the latency in ms, or None if unknown."""
+        if tap is None or not self.offsets:
+            return None
+        _wire, offset = min(self.offsets)  # least wire time: best estimate
+        ms = since_us((tap + offset) & MASK, now_us()) / 1000
+        if not 0 <= ms < MAX_TAP_AGE:
+            return None
+        self.tap.add(ms)
+        return ms
+
+    def format(self):
+        """One log line: both histograms and the frame counters."""
+        return (f"Latency: telemetry->panel {self.photon.format()}; "
+                f"tap->command {self.tap.format()}; frames sent {self.sent} "
+                f"acked {self.acked} lost {self.lost} late {self.late} "
+                f"reordered {self.reordered} unchanged {self.unchanged} "
+                f"superseded {self.superseded}")
@@ -0,0 +1,191 @@
+"""Serial link speed negotiation.
+
+Both ends start at DEFAULT_BAUD. A display that can go faster lists its
+rates in the hello ("baud": [...]); the bridge offers the fastest one it
+also allows:
+
+    bridge  -> {"baud": 921600}
+    display -> {"baud": 921600}       (or 0 to refuse), then switches
+    bridge     switches too and sends PROBES MSG_PROBE frames, each of
+               which the display echoes back
+
+The rate is kept only if every probe comes back intact within
+PROBE_TIMEOUT. Otherwise the bridge goes back to DEFAULT_BAUD (the display
+does the same TRIAL seconds after switching) and says hello again, which
+leads to the next lower rate. At a negotiated rate, MAX_ERRORS bad frames
+within ERROR_WINDOW seconds also send both ends back. A rate that failed
+is not offered again until the port is reopened. Keep in sync with
+LCD/lib/TravelProto/TravelProto.h (LINK SPEED).
+"""
+import json
+import time
+
+import protocol
+
+DEFAULT_BAUD = 115200
+PROBES = 4
+PROBE_LEN = 48       # payload bytes, TP_PROBE_MAX
+ACK_TIMEOUT = 1.0    # seconds for the display to answer an offer
+SETTLE = 0.05        # seconds after switching before the first probe
+PROBE_TIMEOUT = 0.25
+TRIAL = 1.5          # TP_BAUD_TRIAL_MS: display falls back without probes
+ERROR_WINDOW = 30    # TP_BAUD_ERROR_WINDOW_MS
+MAX_ERRORS = 3
+
+
+def probe_payload(seq):
+    """Sequence number plus a pattern that walks through every byte value
+    over the probes, with the bit patterns that show a wrong rate first."""
+    body = bytes(((seq * PROBE_LEN + i) * 97 + 0x55) & 0xFF for i in range(PROBE_LEN - 5))
+    return bytes([seq, 0x00, 0xFF, 0x55, 0xAA]) + body
+
+
+class LinkSpeed:
+    """Owns the port's baud rate for one SerialBridge.
+
+    write(bytes) sends to the display, restart() says hello again at the
+    default rate, resumed() is called whenever a negotiation ends.
+    Everything runs on the bridge's event loop."""
+
+    def __init__(self, loop, rates, write, restart, resumed):
+        self.loop = loop
+        self.rates = sorted(rates, reverse=True)
+        self.write = write
+        self.restart = restart
+        self.resumed = resumed
+        self.ser = None
+        self.attach(None)
+
+    def attach(self, ser):
+        """New (or no) port, opened at DEFAULT_BAUD."""
+        self.cancel()
+        self.ser = ser
+        self.baud = DEFAULT_BAUD
+        self.failed = set()  # rates not to offer again on this port
+        self.trying = None   # rate being negotiated
+        self.probing = False  # ...and both ends have switched to it
+        self.errors = []     # times of recent bad frames
+        self.total_errors = 0
+        self.fallbacks = 0
+
+    def cancel(self):
+        for name in ('timer', 'restart_timer'):
+            timer = getattr(self, name, None)
+            if timer:
+                timer.cancel()
+            setattr(self, name, None)
+
+    @property
+    def busy(self):
+        """A switch is in progress; nothing else may be sent."""
+        return self.trying is not None
+
+    def offer(self, display_rates):
+        """Display hello arrived, listing display_rates."""
+        if self.restart_timer:
+            self.restart_timer.cancel()  # the display said hello first
+            self.restart_timer = None
+        if self.busy or self.baud != DEFAULT_BAUD or not isinstance(display_rates, list):
+            return
+        candidates = [r for r in self.rates
+                      if r in display_rates and r not in self.failed and r > DEFAULT_BAUD]
+        if not candidates:
+            return
+        self.trying = candidates[0]
+        self.write((json.dumps({"baud": self.trying}) + '\n').encode('utf-8'))
+        if not self.busy:
+            return  # the write failed and detached the port
+        self.timer = self.loop.call_later(ACK_TIMEOUT, lambda: self.fail("no answer"))
+
+    def on_ack(self, rate):
+        """{"baud": rate} from the display."""
+        if self.trying is None or self.probing:
+            return
+        if rate != self.trying:
+            self.fail("refused")
+            return
+        self.timer.cancel()
+        try:
+            self.ser.flush()
+            self.ser.baudrate = rate
+        except (ValueError, OSError) as e:  # SerialException is an OSError
+            self.fail(f"adapter: {e}")
+            return
+        self.probing = True
+        self.seq = 0
+        self.rtts = []
+        self.timer = self.loop.call_later(SETTLE, self.send_probe)
+
+    def send_probe(self):
+        self.expect = probe_payload(self.seq)
+        self.sent_at = time.monotonic()
+        self.write(b'\x00' + protocol.encode_frame(protocol.MSG_PROBE, self.expect))
+        if not self.busy:
+            return
+        seq = self.seq
+        self.timer = self.loop.call_later(PROBE_TIMEOUT, lambda: self.fail(f"probe {seq} lost"))
+
+    def on_probe(self, payload):
+        """Echoed MSG_PROBE frame from the display."""
+        if not self.probing:
+            return
+        if payload != self.expect:
+            self.fail(f"probe {self.seq} corrupted")
+            return
+        self.timer.cancel()
+        self.rtts.append(time.monotonic() - self.sent_at)
+        self.seq += 1
+        if self.seq < PROBES:
+            self.send_probe()
+            return
+        self.baud, self.trying, self.timer = self.trying, None, None
+        self.probing = False
+        self.errors = []
+        print(f"Link speed: {self.baud} baud ({PROBES} probes, "
+              f"rtt avg {sum(self.rtts) / len(self.rtts) * 1000:.1f} ms)")
+        self.resumed()
+
+    def fail(self, reason):
+        """Negotiation of self.trying failed: back to the default rate."""
+        if self.ser is None:
+            return  # port gone; attach() starts over
+        if self.timer:
+            self.timer.cancel()
+        rate, self.trying, self.timer = self.trying, None, None
+        self.probing = False
+        self.failed.add(rate)
+        print(f"Link speed: {rate} baud failed ({reason}), staying at {DEFAULT_BAUD}")
+        self.set_default()
+        # The display gives up TRIAL after switching and says hello itself;
+        # if it kept the rate (lost last echo), our hello makes it fall back
+        self.restart_timer = self.loop.call_later(TRIAL, self.on_restart)
+        self.resumed()
+
+    def error(self):
+        """A bad frame or JSON line arrived. Too many at a negotiated rate: fall back."""
+        self.total_errors += 1
+        if self.busy or self.baud == DEFAULT_BAUD:
+            return
+        now = time.monotonic()
+        self.errors = [t for t in self.errors if now - t < ERROR_WINDOW] + [now]
+        if len(self.errors) < MAX_ERRORS:
+            return
+        print(f"Link speed: {len(self.errors)} errors at {self.baud} baud, "
+              f"falling back to {DEFAULT_BAUD} ({self.total_errors} bad frames since connecting)")
+        self.failed.add(self.baud)
+        self.fallbacks += 1
+        self.set_default()
+        self.restart()
+
+    def set_default(self):
+        self.baud = DEFAULT_BAUD
+        if self.ser is None:
+            return
+        try:
+            self.ser.baudrate = DEFAULT_BAUD
+        except (ValueError, OSError) as e:
+            print(f"Link speed: cannot restore {DEFAULT_BAUD}: {e}")
+
+    def on_restart(self):
+        self.restart_timer = None
+        self.restart()
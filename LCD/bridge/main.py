@@ -2,17 +2,134 @@ import time
 import json
 import psutil
 import serial
-import serial.tools.list_ports
-import threading
 import os
-import subprocess
 import socket
+import struct
+
+import actions
+import latency
+import linkspeed
+import ports
+import protocol
+from collectors import Collector, NetRates, drain, open_address_watch, sum_rates
+from eventloop import EventLoop
+from jobs import JobExecutor, job_message
+from perfstats import PerfStats
 
 # Configuration
-SERIAL_BAUDRATE = 115200
+SERIAL_BAUDRATE = linkspeed.DEFAULT_BAUD  # Both ends start here
+# Faster rates offered to displays that list them in their hello, each kept
+# only if it passes a probe exchange (see linkspeed.py). () stays at
+# SERIAL_BAUDRATE. CP210x adapters top out at 921600, CH340 at 2000000.
+BAUD_RATES = (2000000, 921600, 460800, 230400)
+SERIAL_PORT = os.environ.get("TRAVEL_LCD_PORT")  # e.g. the emulator's /tmp/ttyLCD
 UPDATE_INTERVAL = 2  # Seconds
+HELLO_TIMEOUT = 2  # Seconds to wait for the display to answer the protocol offer
+# Hellos sent to a newly opened port before giving up on it: opening it can
+# reset the ESP32, which only answers once it has booted
+HELLO_ATTEMPTS = 4
+RECONNECT_INTERVAL = 5  # Seconds between port scans without udev events
+RESCAN_INTERVAL = 60  # ...with them, in case one was missed
+RECONNECT_DELAY = 0.5  # Seconds after a serial error before scanning again
+REJECT_HOLDOFF = 60  # Seconds before a port that didn't answer is tried again
+MAX_LINE = 4096  # Bytes buffered from the display without a line/frame end
+
+# Delta mode: only fields that moved at least this much since they were last
+# sent are transmitted (display units; fields not listed: any change)
+DELTA_DEADBAND = {
+    "cpu": 2.0,           # %
+    "ram_percent": 1.0,   # %
+    "ram_used": 16,       # MB
+    "disk_percent": 0.1,  # %
+    "temp": 0.5,          # C
+    "uptime": 60,         # s
+}
+KEYFRAME_INTERVAL = 30  # Seconds between full telemetry frames in delta mode
+PERF_WINDOW = 360  # Display perf reports kept for percentiles (~1 h at 10 s)
+LATENCY_REPORT_INTERVAL = 60  # Seconds between latency histogram log lines
+
+# Refresh interval of each metric in seconds; telemetry reuses the cached
+# values in between. Addresses follow netlink change events instead
+# (polled every NET_POLL_INTERVAL only where netlink is unavailable).
+COLLECT_INTERVALS = {
+    "cpu": 1,
+    "ram": 2,
+    "temp": 5,
+    "disk": 60,
+    "traffic": UPDATE_INTERVAL,  # one /proc/net/dev read per telemetry frame
+}
+NET_POLL_INTERVAL = 30
+NET_SETTLE = 0.5  # Seconds to let a burst of address events finish
+COST_REPORT_INTERVAL = 600  # Seconds between collector cost log lines
+
+# Throughput is reported per role: the access point clients connect to and
+# whichever upstream links carry the traffic out
+HOTSPOT_IFACES = ("wlan0",)
+UPLINK_IFACES = ("wlan1", "eth0", "usb0")
+
+# Display actions and their commands: see actions.py (generated from
+# LCD/actions/actions.json)
+MAX_JOBS = 2  # Commands running at the same time; more wait in a queue
+JOB_TIMEOUT = 300  # Seconds before a command is killed (reported as rc -1)
 
 class SystemMonitor:
+    def __init__(self, loop):
+        self.loop = loop
+        self.collectors = {
+            "cpu": Collector("cpu", self.get_cpu_usage, COLLECT_INTERVALS["cpu"]),
+            "ram": Collector("ram", self.get_ram_usage, COLLECT_INTERVALS["ram"]),
+            "disk": Collector("disk", self.get_disk_usage, COLLECT_INTERVALS["disk"]),
+            "temp": Collector("temp", self.get_temperature, COLLECT_INTERVALS["temp"]),
+            "net": Collector("net", self.get_network_info, None),
+            "traffic": Collector("traffic", NetRates().read, COLLECT_INTERVALS["traffic"]),
+            "boot": Collector("boot", psutil.boot_time, None),  # read once
+        }
+        self.net_refresh = None  # Pending refresh after an address event
+
+    def start(self):
+        for collector in self.collectors.values():
+            collector.schedule(self.loop)
+        watch = open_address_watch()
+        if watch:
+            self.loop.add_reader(watch, lambda: self.on_address_event(watch))
+        else:
+            print("Netlink unavailable, polling interface addresses")
+            self.collectors["net"].interval = NET_POLL_INTERVAL
+            self.collectors["net"].schedule(self.loop)
+        self.loop.call_later(COST_REPORT_INTERVAL, self.report_costs)
+
+    def on_address_event(self, sock):
+        drain(sock)
+        if not self.net_refresh:
+            self.net_refresh = self.loop.call_later(NET_SETTLE, self.refresh_net)
+
+    def refresh_net(self):
+        self.net_refresh = None
+        self.collectors["net"].refresh()
+
+    def snapshot(self):
+        """Telemetry dict built from the cached values."""
+        c = self.collectors
+        return {
+            "cpu": c["cpu"].value,
+            "ram": c["ram"].value,
+            "disk": c["disk"].value,
+            "temp": c["temp"].value,
+            "net": c["net"].value,
+            "traffic": self.get_traffic(),
+            "uptime": self.get_uptime()
+        }
+
+    def costs(self):
+        """{collector: (runs, total ms, average ms)} since start."""
+        return {name: c.cost() for name, c in self.collectors.items()}
+
+    def report_costs(self):
+        self.loop.call_later(COST_REPORT_INTERVAL, self.report_costs)
+        print("Collector cost: " + ", ".join(
+            f"{name} {runs}x {total:.1f}ms (avg {avg:.2f}ms)"
+            for name, (runs, total, avg) in self.costs().items()))
+
     def get_cpu_usage(self):
         return psutil.cpu_percent(interval=None)
 
@@ -61,109 +178,347 @@ class SystemMonitor:
                         net_info[iface] = addr.address
         return net_info
         
+    def get_traffic(self):
+        rates = self.collectors["traffic"].value or {}
+        return {"uplink": sum_rates(rates, UPLINK_IFACES),
+                "hotspot": sum_rates(rates, HOTSPOT_IFACES)}
+
     def get_uptime(self):
-        return int(time.time() - psutil.boot_time())
+        return int(time.time() - self.collectors["boot"].value)
 
 class SerialBridge:
+    """Owns the serial port. Everything runs on one EventLoop: reads wake it
+    as soon as the display sends something, telemetry and reconnects are
+    timers, so nothing touches the port concurrently."""
+
     def __init__(self):
         self.ser = None
-        self.monitor = SystemMonitor()
-        self.running = True
-
-    def find_esp32(self):
-        ports = list(serial.tools.list_ports.comports())
-        for port in ports:
-            # Common ESP32 USB-Serial descriptions/VIDs
-            if "CP210" in port.description or "CH340" in port.description or "USB Serial" in port.description:
-                return port.device
-        # Fallback to standard linux locations if auto-detection fails
-        if os.path.exists('/dev/ttyUSB0'): return '/dev/ttyUSB0'
-        if os.path.exists('/dev/ttyACM0'): return '/dev/ttyACM0'
-        return None
+        self.loop = EventLoop()
+        self.monitor = SystemMonitor(self.loop)
+        self.rx = protocol.Deframer(MAX_LINE)  # Lines and frames from the display
+        self.binary = False  # Binary telemetry negotiated with the display
+        self.delta = False   # Display applies partial updates
+        self.trace = False   # Display acknowledges stamped telemetry
+        self.hello_timer = None  # Pending negotiation timeout
+        self.port = None
+        self.identified = False  # The port answered as a display
+        self.rejected = {}  # port -> monotonic time it may be tried again
+        self.trusted = False  # Port kept even without a hello (JSON display)
+        self.hellos = 0  # Hellos sent since the port was opened
+        self.connect_timer = None
+        self.scan_interval = RECONNECT_INTERVAL
+        self.found_at = None  # When the port being connected was found
+        self.hello_at = None  # ...and when it answered as a display
+        self.lost_at = None   # When the last connection failed
+        self.telemetry_timer = None
+        self.tracker = protocol.DeltaTracker(DELTA_DEADBAND, KEYFRAME_INTERVAL)
+        self.perf = PerfStats(PERF_WINDOW)
+        self.latency = latency.LatencyTrace()
+        self.jobs = JobExecutor(self.loop, {a.name: a.argv for a in actions.ACTIONS},
+                                self.job_update, MAX_JOBS, JOB_TIMEOUT)
+        self.link = linkspeed.LinkSpeed(self.loop, BAUD_RATES, self.write,
+                                        self.negotiate, self.send_keyframe)
+
+    def candidates(self):
+        # (port, trusted): the configured port and known adapters are trusted
+        if SERIAL_PORT:
+            return [(SERIAL_PORT, True)] if os.path.exists(SERIAL_PORT) else []
+        now = time.monotonic()
+        return [(port, adapter is not None) for port, adapter in ports.candidate_ports()
+                if self.rejected.get(port, 0) <= now]
 
     def connect(self):
-        while self.running:
-            port = self.find_esp32()
-            if port:
+        # Open the first candidate; the hello decides whether it is the display
+        if self.connect_timer:
+            self.connect_timer.cancel()
+            self.connect_timer = None
+        if self.ser:
+            return
+        if self.found_at is None:
+            self.found_at = time.monotonic()
+        for port, trusted in self.candidates():
+            try:
+                # timeout=0: reads return whatever is buffered, never block the loop
+                self.ser = serial.Serial(port, SERIAL_BAUDRATE, timeout=0, rtscts=False, dsrdtr=False)
                 try:
-                    self.ser = serial.Serial(port, SERIAL_BAUDRATE, timeout=1, rtscts=False, dsrdtr=False)
                     self.ser.dtr = False
                     self.ser.rts = False
-                    print(f"Connected to ESP32 on {port}")
-                    self.ser.reset_input_buffer()
-                    return True
-                except Exception as e:
-                    print(f"Failed to connect: {e}")
-            else:
-                print("ESP32 not found. Retrying...")
-            time.sleep(5)
+                except OSError:
+                    pass  # no modem lines on a pty (emulator)
+                print(f"Opened {port}, waiting for the display's hello")
+                self.port = port
+                self.trusted = trusted
+                self.identified = False
+                self.hello_at = None
+                self.hellos = 0
+                self.ser.reset_input_buffer()
+                self.rx.reset()
+                self.link.attach(self.ser)
+                self.loop.add_reader(self.ser, self.on_readable)
+                self.negotiate()
+                return
+            except Exception as e:
+                print(f"Failed to open {port}: {e}")
+                self.release()
+        print("Display not found, waiting for it")
+        self.found_at = None
+        self.connect_timer = self.loop.call_later(self.scan_interval, self.connect)
 
-    def read_loop(self):
-        print("Read loop started")
-        while self.running:
-            if self.ser and self.ser.is_open:
-                try:
-                    if self.ser.in_waiting > 0:
-                        line = self.ser.readline().decode('utf-8').strip()
-                        if line:
-                            # Debug: print all lines
-                            print(f"[RAW] {line}")
-                            self.handle_command(line)
-                except Exception as e:
-                    print(f"Read error: {e}")
-                    self.ser.close()
+    def release(self):
+        # Close the port and forget its session; only ever called from the loop
+        self.loop.remove_reader(self.ser)
+        for timer in (self.hello_timer, self.telemetry_timer):
+            if timer:
+                timer.cancel()
+        self.hello_timer = self.telemetry_timer = None
+        self.link.attach(None)
+        try:
+            self.ser.close()
+        except Exception:
+            pass
+        self.ser = None
+        self.identified = False
+
+    def disconnect(self, reason):
+        print(f"Serial error: {reason}")
+        self.release()
+        self.lost_at = time.monotonic()
+        self.found_at = None
+        self.connect_timer = self.loop.call_later(RECONNECT_DELAY, self.connect)
+
+    def on_hotplug(self, sock):
+        for action, device in ports.read_tty_events(sock):
+            if action == "remove" and self.ser and device == self.port:
+                self.disconnect("unplugged")
+            elif action in ("add", "change"):
+                if action == "add":
+                    self.rejected.pop(device, None)  # replugged: worth another try
+                if not self.ser:
+                    self.found_at = time.monotonic()
                     self.connect()
-            time.sleep(0.1)
+
+    def negotiate(self):
+        # Offer the binary protocol; stay on JSON if the display doesn't answer
+        # The leading NUL flushes any half-received frame on the display side
+        self.binary = False
+        self.delta = False
+        self.trace = False
+        self.ser.write(b'\x00' + (json.dumps(protocol.HELLO) + '\n').encode('utf-8'))
+        self.hellos += 1
+        self.hello_timer = self.loop.call_later(HELLO_TIMEOUT, self.hello_timeout)
+
+    def hello_timeout(self):
+        self.hello_timer = None
+        if not self.identified:
+            if self.hellos < HELLO_ATTEMPTS:
+                self.negotiate()  # May still be booting
+                return
+            if not self.trusted:
+                # Some other USB serial device: leave it alone for a while
+                print(f"No display hello on {self.port}, trying the next port")
+                self.rejected[self.port] = time.monotonic() + REJECT_HOLDOFF
+                self.release()
+                self.connect()
+                return
+            # The configured port or a known adapter: a JSON-only display
+            print(f"No hello on {self.port}, keeping it as a JSON display")
+            self.identified = True
+        self.negotiated()
+
+    def negotiated(self):
+        # Hello answered or timed out: (re)start telemetry with a keyframe now
+        if self.hello_timer:
+            self.hello_timer.cancel()
+            self.hello_timer = None
+        print(f"Telemetry protocol: {'binary v%d' % protocol.PROTO_VERSION if self.binary else 'JSON'}"
+              f"{' (delta)' if self.delta else ''}")
+        self.send_keyframe()
+
+    def send_keyframe(self):
+        # The display (re)synced: full frame now rather than at the next tick
+        if not self.ser:
+            return
+        self.tracker.reset()
+        if self.telemetry_timer:
+            self.telemetry_timer.cancel()
+        self.telemetry_tick()
+        if self.found_at is not None and self.ser and not self.link.busy:
+            self.report_connect()
+
+    def report_connect(self):
+        # First keyframe on a newly opened port: how long the display was blank
+        now = time.monotonic()
+        hello = (f" (hello after {(self.hello_at - self.found_at) * 1000:.0f} ms)"
+                 if self.hello_at else " (no hello)")
+        offline = f", {now - self.lost_at:.1f} s after the link was lost" if self.lost_at else ""
+        print(f"Display connected on {self.port}: keyframe sent "
+              f"{(now - self.found_at) * 1000:.0f} ms after finding the port{hello}{offline}")
+        self.found_at = self.lost_at = None
+
+    def handle_hello(self, msg):
+        # The display also announces itself at boot, so this can arrive at any time
+        if not isinstance(msg, dict) or "hello" not in msg:
+            return False
+        if msg["hello"] != protocol.DISPLAY_ID:
+            print(f"Ignoring hello from another device: {msg}")
+            return True
+        if not self.identified:
+            self.identified = True
+            self.hello_at = time.monotonic()
+        self.binary = msg.get("proto") == protocol.PROTO_VERSION
+        self.delta = bool(msg.get("delta"))
+        self.trace = self.binary and bool(msg.get("trace"))
+        self.perf.reset()
+        self.latency.reset()
+        print(f"Display hello: {msg}")
+        self.negotiated()  # Keyframe at the default rate before any switch
+        self.link.offer(msg.get("baud"))
+        return True
+
+    def on_readable(self):
+        try:
+            data = self.ser.read(self.ser.in_waiting or 1)
+        except (serial.SerialException, OSError) as e:
+            self.disconnect(e)
+            return
+        for kind, raw in self.rx.feed(data):
+            if not self.identified:
+                # Until it says hello, the port may not be a display at all
+                if kind == protocol.Deframer.LINE:
+                    self.handle_candidate(raw)
+                continue
+            if kind == protocol.Deframer.FRAME:
+                self.handle_frame(raw)
+                continue
+            line = raw.decode('utf-8', errors='ignore').strip()
+            if not line:
+                continue
+            # Debug: print all lines
+            if kind == protocol.Deframer.CUT:
+                print(f"[RAW] {line} (cut off)")  # not an error: a frame interrupted it
+            else:
+                print(f"[RAW] {line}")
+                self.handle_command(line)
+
+    def handle_candidate(self, raw):
+        try:
+            self.handle_hello(json.loads(raw.decode('utf-8', errors='ignore')))
+        except ValueError:
+            pass  # boot messages, or another device's output
+
+    def handle_frame(self, raw):
+        frame = protocol.decode_frame(raw)
+        if not frame:
+            print(f"Dropped bad frame from display: {raw.hex()}")
+            self.link.error()
+            return
+        msg_type, payload = frame
+        if msg_type == protocol.MSG_PROBE:
+            self.link.on_probe(payload)
+        elif msg_type == protocol.MSG_ACK:
+            self.latency.on_ack(payload)
+        elif msg_type == protocol.MSG_COMMAND and len(payload) >= 1:
+            action = actions.BY_OP.get(payload[0])
+            # Displays from before the tap time send the opcode alone
+            tap = struct.unpack_from('<I', payload, 1)[0] if len(payload) >= 5 else None
+            print(f"Received command: op {payload[0]} ({action.name if action else 'unknown'})"
+                  f"{self.tap_latency(tap)}")
+            # Unknown opcodes are rejected by the executor like unknown names
+            self.jobs.submit(action.name if action else f"op{payload[0]}")
 
     def handle_command(self, data):
+        if not data.startswith('{'):
+            return  # firmware log output (boot messages, theme changes, ...)
         try:
             cmd = json.loads(data)
-            print(f"Received command: {cmd}")
-            
-            if cmd.get("action") == "reboot":
-                subprocess.run(["sudo", "reboot"])
-            elif cmd.get("action") == "shutdown":
-                subprocess.run(["sudo", "shutdown", "-h", "now"])
-            elif cmd.get("action") == "reset_network":
-                subprocess.run(["sudo", "/home/raltmeyer/pi4-travelserver/scripts/full_network_reset.sh"])
-            elif cmd.get("action") == "fw_strict":
-                subprocess.run(["sudo", "/home/raltmeyer/pi4-travelserver/scripts/firewall_strict.sh"])
-            elif cmd.get("action") == "fw_maint":
-                subprocess.run(["sudo", "/home/raltmeyer/pi4-travelserver/scripts/firewall_maintenance.sh"])
-            elif cmd.get("action") == "start_smb":
-                subprocess.run(["sudo", "/home/raltmeyer/pi4-travelserver/scripts/start_fileserver.sh"])
-            elif cmd.get("action") == "stop_smb":
-                subprocess.run(["sudo", "/home/raltmeyer/pi4-travelserver/scripts/stop_fileserver.sh"])
-            
+            if self.handle_hello(cmd):
+                return
+            if isinstance(cmd, dict) and isinstance(cmd.get("baud"), int):
+                self.link.on_ack(cmd["baud"])
+                return
+            if isinstance(cmd, dict) and isinstance(cmd.get("perf"), dict):
+                self.perf.add(cmd["perf"])
+                print(self.perf.format(cmd["perf"]))
+                return
+            tap = cmd.get("t") if isinstance(cmd, dict) else None
+            print(f"Received command: {cmd}"
+                  f"{self.tap_latency(tap if isinstance(tap, int) else None)}")
+            if isinstance(cmd, dict) and isinstance(cmd.get("action"), str):
+                self.jobs.submit(cmd["action"])
+
         except json.JSONDecodeError:
             print(f"Invalid JSON received: {data}")
+            self.link.error()
 
-    def write_loop(self):
-        while self.running:
-            if self.ser and self.ser.is_open:
-                try:
-                    stats = {
-                        "cpu": self.monitor.get_cpu_usage(),
-                        "ram": self.monitor.get_ram_usage(),
-                        "disk": self.monitor.get_disk_usage(),
-                        "temp": self.monitor.get_temperature(),
-                        "net": self.monitor.get_network_info(),
-                        "uptime": self.monitor.get_uptime()
-                    }
-                    json_stats = json.dumps(stats)
-                    self.ser.write((json_stats + '\n').encode('utf-8'))
-                except Exception as e:
-                    print(f"Write error: {e}")
-            time.sleep(UPDATE_INTERVAL)
+    def tap_latency(self, tap):
+        # Log suffix; also adds the sample to the tap histogram
+        ms = self.latency.on_command(tap)
+        return f", tapped {ms:.1f} ms ago" if ms is not None else ""
+
+    def report_latency(self):
+        self.loop.call_later(LATENCY_REPORT_INTERVAL, self.report_latency)
+        if self.latency.sent or self.latency.tap.n:
+            print(self.latency.format())
+
+    def job_update(self, job, state):
+        msg = job_message(job, state)
+        print(f"Job: {msg['job']}")
+        if not self.ser:
+            return  # Display gone; it will not be waiting for this job anymore
+        try:
+            self.ser.write((json.dumps(msg, separators=(',', ':')) + '\n').encode('utf-8'))
+        except (serial.SerialException, OSError) as e:
+            self.disconnect(e)
+
+    def write(self, data):
+        try:
+            self.ser.write(data)
+        except (serial.SerialException, OSError) as e:
+            self.disconnect(e)
+
+    def send_telemetry(self, stats):
+        if self.link.busy:
+            return  # Switching rates; the next frame after it is a keyframe
+        mask = protocol.MASK_ALL
+        if self.delta:
+            mask = self.tracker.changes(protocol.flatten(stats))
+            if not mask:
+                return  # Nothing moved past its deadband
+
+        if self.binary:
+            if mask == protocol.MASK_ALL:
+                frame = protocol.encode_telemetry(stats)
+            else:
+                frame = protocol.encode_delta(stats, mask)
+            if self.trace:
+                frame = self.latency.stamp() + frame  # one write, back to back
+            self.ser.write(frame)
+        else:
+            if mask != protocol.MASK_ALL:
+                stats = protocol.json_delta(stats, mask)
+            json_stats = json.dumps(stats)
+            self.ser.write((json_stats + '\n').encode('utf-8'))
+
+    def telemetry_tick(self):
+        self.telemetry_timer = self.loop.call_later(UPDATE_INTERVAL, self.telemetry_tick)
+        try:
+            self.send_telemetry(self.monitor.snapshot())
+        except (serial.SerialException, OSError) as e:
+            self.disconnect(e)
+        except Exception as e:
+            print(f"Write error: {e}")
 
     def start(self):
+        self.monitor.start()
+        watch = None if SERIAL_PORT else ports.open_udev_watch()
+        if watch:
+            self.loop.add_reader(watch, lambda: self.on_hotplug(watch))
+            self.scan_interval = RESCAN_INTERVAL
+        elif not SERIAL_PORT:
+            print("udev events unavailable, polling for the display")
+        self.loop.call_later(LATENCY_REPORT_INTERVAL, self.report_latency)
         self.connect()
-        
-        read_thread = threading.Thread(target=self.read_loop)
-        read_thread.daemon = True
-        read_thread.start()
-        
-        self.write_loop()
+        self.loop.run()
 
 if __name__ == "__main__":
     bridge = SerialBridge()
@@ -171,4 +526,4 @@ if __name__ == "__main__":
         bridge.start()
     except KeyboardInterrupt:
         print("Stopping bridge...")
-        bridge.running = False
+        bridge.loop.stop()
@@ -0,0 +1,74 @@
+"""Rolling statistics over the display's periodic {"perf": {...}} reports.
+
+Each report covers one window on the device (PERF_REPORT_MS, default
+10 s): section timers as [count, avg_us, max_us], frames per second,
+bytes sent to the panel, free / minimum free heap and, on firmware_v2,
+LVGL heap usage as [used %, fragmentation %, biggest free block,
+high-water bytes] (older builds omit the high-water mark), and the serial
+link as [baud, bad frames since boot, fallbacks to the default rate].
+"""
+import math
+from collections import deque
+
+
+def percentile(sorted_values, p):
+    """Nearest-rank percentile of an already sorted, non-empty list."""
+    return sorted_values[max(0, math.ceil(p / 100 * len(sorted_values)) - 1)]
+
+
+def flatten(report):
+    """{"perf": {...}} body -> {metric name: number}."""
+    out = {}
+    for key in ('fps', 'bytes'):
+        if key in report:
+            out[key] = report[key]
+    heap = report.get('heap')
+    if heap and heap[0]:  # the emulator reports 0
+        out['heap_free'], out['heap_min'] = heap[0], heap[1]
+    lv = report.get('lv')
+    if lv:
+        out['lv_used_pct'], out['lv_frag_pct'], out['lv_biggest'] = lv[:3]
+        if len(lv) > 3:
+            out['lv_max_used'] = lv[3]
+    link = report.get('link')
+    if link:
+        out['link_baud'], out['link_errors'], out['link_fallbacks'] = link[:3]
+    for name, (_count, avg_us, max_us) in report.get('t', {}).items():
+        out[name + '_avg_us'] = avg_us
+        out[name + '_max_us'] = max_us
+    return out
+
+
+class PerfStats:
+    """Keeps the last `window` values of every metric."""
+
+    PERCENTILES = (50, 95, 99)
+
+    def __init__(self, window):
+        self.window = window
+        self.series = {}
+
+    def reset(self):
+        # A new display (or a reboot) starts from scratch
+        self.series.clear()
+
+    def add(self, report):
+        for name, value in flatten(report).items():
+            self.series.setdefault(name, deque(maxlen=self.window)).append(value)
+
+    def summary(self):
+        """{metric: (p50, p95, p99, samples)} over the rolling window."""
+        out = {}
+        for name, values in self.series.items():
+            ordered = sorted(values)
+            out[name] = tuple(percentile(ordered, p) for p in self.PERCENTILES) + (len(ordered),)
+        return out
+
+    def format(self, report):
+        """One log line: this report's values, then rolling p50/p95/p99."""
+        summary = self.summary()
+        parts = []
+        for name, value in flatten(report).items():
+            p50, p95, p99, _n = summary[name]
+            parts.append(f"{name}={value:g} (p50 {p50:g} p95 {p95:g} p99 {p99:g})")
+        return "Display perf: " + ", ".join(parts)
@@ -0,0 +1,92 @@
+"""Finding the display's serial port.
+
+Any USB serial device is a candidate, known display adapters first; the
+bridge opens each in turn and keeps the one that answers its hello as a
+display (see SerialBridge.connect). A known adapter that stays silent is
+kept too, as a display that only takes JSON. Instead of polling for the
+display to be plugged in, the bridge listens to udev: the same netlink
+messages libudev monitors receive, sent once udev has created the device
+node. Where that socket is unavailable it polls.
+"""
+import socket
+import struct
+
+import serial.tools.list_ports
+
+NETLINK_KOBJECT_UEVENT = 15  # linux/netlink.h
+UDEV_GROUP = 2  # events udev has processed (group 1: raw kernel events)
+
+# libudev's message header: "libudev\0", magic (big-endian), then header
+# size, properties offset and properties length in host byte order
+UDEV_HEADER = struct.Struct('=8s4sIII')
+UDEV_PREFIX = b'libudev\0'
+
+# (vid, pid) of the USB serial adapters displays are known to use
+KNOWN_ADAPTERS = {
+    (0x10C4, 0xEA60): "CP210x",
+    (0x1A86, 0x7523): "CH340",
+    (0x1A86, 0x55D4): "CH9102",
+    (0x303A, 0x1001): "ESP32 USB-JTAG",
+}
+
+
+def candidate_ports():
+    """(device path, known adapter name or None) of the USB serial ports,
+    known adapters first."""
+    ports = [(p.device, KNOWN_ADAPTERS.get((p.vid, p.pid)))
+             for p in serial.tools.list_ports.comports() if p.vid is not None]
+    ports.sort(key=lambda p: (p[1] is None, p[0]))
+    return ports
+
+
+def open_udev_watch():
+    """Non-blocking netlink socket receiving udev's device events, or None
+    where netlink is unavailable."""
+    try:
+        sock = socket.socket(socket.AF_NETLINK, socket.SOCK_RAW | socket.SOCK_NONBLOCK,
+                             NETLINK_KOBJECT_UEVENT)
+        sock.bind((0, UDEV_GROUP))
+        return sock
+    except (AttributeError, OSError):
+        return None
+
+
+def parse_uevent(msg):
+    """{KEY: value} of one udev (or raw kernel) event message."""
+    if msg.startswith(UDEV_PREFIX):
+        if len(msg) < UDEV_HEADER.size:
+            return {}
+        _prefix, _magic, _size, offset, length = UDEV_HEADER.unpack_from(msg)
+        fields = msg[offset:offset + length].split(b'\0')
+    else:
+        fields = msg.split(b'\0')[1:]  # after "action@devpath"
+    props = {}
+    for field in fields:
+        key, sep, value = field.partition(b'=')
+        if sep:
+            props[key.decode('ascii', 'replace')] = value.decode('utf-8', 'replace')
+    return props
+
+
+def read_tty_events(sock):
+    """(action, device path) of every pending tty event. A lost event
+    (receive buffer overrun) is reported as ("change", None): rescan."""
+    events = []
+    while True:
+        try:
+            msg = sock.recv(65536)
+        except (BlockingIOError, InterruptedError):
+            break
+        except OSError:
+            events.append(("change", None))
+            break
+        if not msg:
+            break
+        props = parse_uevent(msg)
+        name = props.get("DEVNAME")
+        if props.get("SUBSYSTEM") != "tty" or not name:
+            continue
+        if not name.startswith('/'):
+            name = '/dev/' + name
+        events.append((props.get("ACTION"), name))
+    return events
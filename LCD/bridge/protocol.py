@@ -0,0 +1,257 @@
+"""Binary serial protocol shared with the display firmware.
+
+Frames are COBS-encoded and terminated by 0x00:
+
+    [version u8][type u8][payload ...][crc16 lo][crc16 hi]
+
+The CRC is CRC-16/CCITT-FALSE over version, type and payload. Keep in
+sync with LCD/lib/TravelProto/TravelProto.h.
+"""
+import socket
+import struct
+import time
+
+PROTO_VERSION = 1
+
+MSG_TELEMETRY = 0x01        # full struct (keyframe)
+MSG_TELEMETRY_DELTA = 0x02  # [mask u16][fields whose bit is set]
+MSG_STAMP = 0x03            # stamps the next telemetry frame (see latency.py)
+MSG_COMMAND = 0x10          # display -> bridge: [opcode u8][tap u32] (see actions.py)
+MSG_ACK = 0x11              # display -> bridge: stamped telemetry shown (see latency.py)
+MSG_PROBE = 0x20            # link speed check, echoed by the display (see linkspeed.py)
+
+# Interface slots of the telemetry struct, in wire order
+IFACES = ('wlan0', 'wlan1', 'eth0', 'usb0')
+
+# Throughput roles, appended after the addresses: rx B/s, tx B/s, drops/s x10
+RATES = ('uplink', 'hotspot')
+
+# cpu, ram%, ram used/total MB, disk%, disk used/total GB, temp, uptime,
+# 4x IPv4, 2x rates. New fields only ever go at the end: older firmware
+# ignores trailing keyframe bytes and delta bits it doesn't know. The delta
+# mask is 16 bits, so there is room for one more field.
+FIELDS = ('cpu', 'ram_percent', 'ram_used', 'ram_total',
+          'disk_percent', 'disk_used', 'disk_total', 'temp', 'uptime') + IFACES + RATES
+FIELD_FORMATS = (('H', 'H', 'H', 'H', 'H', 'H', 'H', 'h', 'I') + ('4s',) * len(IFACES) +
+                 ('IIH',) * len(RATES))
+TELEMETRY_STRUCT = struct.Struct('<' + ''.join(FIELD_FORMATS))
+MASK_ALL = (1 << len(FIELDS)) - 1
+
+# Top-level JSON key carrying each field; JSON deltas send these objects whole
+JSON_KEYS = ('cpu', 'ram', 'ram', 'ram', 'disk', 'disk', 'disk',
+             'temp', 'uptime') + ('net',) * len(IFACES) + ('traffic',) * len(RATES)
+
+# Sent as a JSON line; a firmware that speaks the binary protocol answers
+# with {"hello": ..., "proto": <version>}. "cmd": 1 lets the display send
+# commands as MSG_COMMAND frames instead of {"action": ...} lines; "trace": 1
+# announces MSG_STAMP frames, which a display answering "trace": 1 acks.
+HELLO = {"hello": 1, "proto": PROTO_VERSION, "cmd": 1, "trace": 1}
+DISPLAY_ID = "travel-lcd"  # "hello" in the display's answer: our firmware
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for b in data:
+        if b == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(b)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(data):
+    """COBS-encoded frame (without delimiters) -> (type, payload), or None
+    if it is malformed or fails the version / CRC check."""
+    body = cobs_decode(data)
+    if (body is None or len(body) < 4 or body[0] != PROTO_VERSION or
+            crc16(body[:-2]) != struct.unpack('<H', body[-2:])[0]):
+        return None
+    return body[1], body[2:-2]
+
+
+class Deframer:
+    """Splits what the display sends into text lines and binary frames.
+
+    Frames arrive as 0x00 COBS(frame) 0x00; text never contains NUL, so a
+    NUL always starts or ends a frame wherever it falls between lines.
+    feed() returns a list of (kind, bytes) in arrival order: LINE, FRAME,
+    or CUT for text a frame started before its newline (the display
+    rebooting mid-line, say). A cut-off line is only fit for the log."""
+
+    LINE, CUT, FRAME = range(3)
+
+    def __init__(self, max_len):
+        self.max_len = max_len
+        self.buf = bytearray()
+        self.in_frame = False
+
+    def reset(self):
+        self.buf.clear()
+        self.in_frame = False
+
+    def feed(self, data):
+        self.buf += data
+        out = []
+        while True:
+            if self.in_frame:
+                end = self.buf.find(0)
+                if end < 0:
+                    break
+                if end:
+                    out.append((self.FRAME, bytes(self.buf[:end])))
+                del self.buf[:end + 1]
+                self.in_frame = False
+                continue
+            nul, nl = self.buf.find(0), self.buf.find(b'\n')
+            if nul >= 0 and (nl < 0 or nul < nl):
+                end, self.in_frame, kind = nul, True, self.CUT
+            elif nl >= 0:
+                end, kind = nl, self.LINE
+            else:
+                break
+            if end:
+                out.append((kind, bytes(self.buf[:end])))
+            del self.buf[:end + 1]
+        if len(self.buf) > self.max_len:
+            self.reset()  # Boot noise without a delimiter
+        return out
+
+
+def encode_frame(msg_type, payload):
+    body = bytes([PROTO_VERSION, msg_type]) + payload
+    body += struct.pack('<H', crc16(body))
+    return cobs_encode(body) + b'\x00'
+
+
+def _fixed(value, scale=10):
+    return max(0, min(0xFFFF, int(round(value * scale))))
+
+
+def _ip(addr):
+    try:
+        return socket.inet_aton(addr)
+    except (OSError, TypeError):
+        return b'\x00\x00\x00\x00'
+
+
+def _rate(rates):
+    return (rates["rx"], rates["tx"], rates["drops"]) if rates else (0, 0, 0.0)
+
+
+def flatten(stats):
+    """Telemetry dict -> tuple of display values in FIELDS order."""
+    ram, disk, net = stats["ram"], stats["disk"], stats["net"]
+    traffic = stats.get("traffic") or {}
+    return ((stats["cpu"], ram["percent"], ram["used"], ram["total"],
+             disk["percent"], disk["used"], disk["total"], stats["temp"],
+             stats["uptime"]) + tuple(net.get(iface) for iface in IFACES) +
+            tuple(_rate(traffic.get(role)) for role in RATES))
+
+
+def _wire(values):
+    """Display values -> wire values; multi-value fields become tuples."""
+    cpu, ram_pct, ram_used, ram_total, disk_pct, disk_used, disk_total, temp, uptime = values[:9]
+    n = 9 + len(IFACES)
+    return ((_fixed(cpu),
+             _fixed(ram_pct), min(ram_used, 0xFFFF), min(ram_total, 0xFFFF),
+             _fixed(disk_pct), min(disk_used, 0xFFFF), min(disk_total, 0xFFFF),
+             max(-32768, min(32767, int(round(temp * 10)))),
+             int(uptime) & 0xFFFFFFFF) + tuple(_ip(addr) for addr in values[9:n]) +
+            tuple((min(rx, 0xFFFFFFFF), min(tx, 0xFFFFFFFF), _fixed(drops))
+                  for rx, tx, drops in values[n:]))
+
+
+def _pack_args(wire):
+    for value in wire:
+        if isinstance(value, tuple):
+            yield from value
+        else:
+            yield value
+
+
+def encode_telemetry(stats):
+    return encode_frame(MSG_TELEMETRY, TELEMETRY_STRUCT.pack(*_pack_args(_wire(flatten(stats)))))
+
+
+def encode_delta(stats, mask):
+    wire = _wire(flatten(stats))
+    payload = struct.pack('<H', mask)
+    for i, fmt in enumerate(FIELD_FORMATS):
+        if mask & (1 << i):
+            payload += struct.pack('<' + fmt, *_pack_args((wire[i],)))
+    return encode_frame(MSG_TELEMETRY_DELTA, payload)
+
+
+def json_delta(stats, mask):
+    """Subset of the telemetry dict covering the fields in mask."""
+    return {JSON_KEYS[i]: stats[JSON_KEYS[i]] for i in range(len(FIELDS)) if mask & (1 << i)}
+
+
+class DeltaTracker:
+    """Decides which telemetry fields need sending.
+
+    A field is sent when it moved at least its deadband (display units,
+    keyed by FIELDS name; default: any change) since it was last sent.
+    Every keyframe_interval seconds, and after reset(), everything is sent.
+    """
+
+    def __init__(self, deadband, keyframe_interval):
+        self.deadband = deadband
+        self.keyframe_interval = keyframe_interval
+        self.reset()
+
+    def reset(self):
+        self.last = None
+        self.last_keyframe = 0
+
+    def changes(self, values):
+        now = time.monotonic()
+        if self.last is None or now - self.last_keyframe >= self.keyframe_interval:
+            self.last = list(values)
+            self.last_keyframe = now
+            return MASK_ALL
+
+        mask = 0
+        for i, (new, old) in enumerate(zip(values, self.last)):
+            band = self.deadband.get(FIELDS[i], 0)
+            if band and isinstance(new, (int, float)) and isinstance(old, (int, float)):
+                changed = abs(new - old) >= band
+            else:
+                changed = new != old
+            if changed:
+                mask |= 1 << i
+                self.last[i] = new
+        return mask
@@ -0,0 +1,126 @@
+"""LinkSpeed against a simulated loop and port (python3 -m unittest)."""
+import unittest
+
+import linkspeed
+import protocol
+from eventloop import Timer
+
+FAST = 921600
+
+
+class FakeLoop:
+    """call_later only; run_until() fires due timers in order."""
+
+    def __init__(self):
+        self.now = 0.0
+        self.timers = []
+
+    def call_later(self, delay, callback):
+        timer = Timer(self.now + delay, callback)
+        self.timers.append(timer)
+        return timer
+
+    def run_until(self, when):
+        while True:
+            due = [t for t in self.timers if not t.cancelled and t.when <= when]
+            if not due:
+                break
+            timer = min(due, key=lambda t: t.when)
+            self.timers.remove(timer)
+            self.now = timer.when
+            timer.callback()
+        self.now = when
+
+    def pending(self):
+        return [t for t in self.timers if not t.cancelled]
+
+
+class FakePort:
+    def __init__(self):
+        self.baudrate = linkspeed.DEFAULT_BAUD
+        self.written = []
+
+    def flush(self):
+        pass
+
+
+class Bridge:
+    """The parts of SerialBridge LinkSpeed talks to. A write on an unplugged
+    port detaches it, as SerialBridge.disconnect() does."""
+
+    def __init__(self):
+        self.loop = FakeLoop()
+        self.port = FakePort()
+        self.unplugged = False
+        self.restarts = 0
+        self.link = linkspeed.LinkSpeed(self.loop, [FAST], self.write,
+                                        self.restart, lambda: None)
+        self.link.attach(self.port)
+
+    def write(self, data):
+        if self.unplugged:
+            self.link.attach(None)
+            return
+        self.port.written.append(data)
+
+    def restart(self):
+        self.restarts += 1
+
+
+class LinkSpeedTest(unittest.TestCase):
+    def test_probes_commit_rate(self):
+        b = Bridge()
+        b.link.offer([FAST])
+        b.link.on_ack(FAST)
+        for seq in range(linkspeed.PROBES):
+            b.loop.run_until(b.loop.now + linkspeed.SETTLE)
+            b.link.on_probe(linkspeed.probe_payload(seq))
+        self.assertEqual(FAST, b.link.baud)
+        self.assertEqual(FAST, b.port.baudrate)
+        self.assertFalse(b.link.busy)
+
+    def test_lost_probe_falls_back(self):
+        b = Bridge()
+        b.link.offer([FAST])
+        b.link.on_ack(FAST)
+        b.loop.run_until(1.0)
+        self.assertEqual(linkspeed.DEFAULT_BAUD, b.port.baudrate)
+        self.assertIn(FAST, b.link.failed)
+        b.loop.run_until(1.0 + linkspeed.TRIAL)
+        self.assertEqual(1, b.restarts)
+
+    def test_unplugged_during_offer(self):
+        b = Bridge()
+        b.unplugged = True
+        b.link.offer([FAST])
+        self.assertIsNone(b.link.ser)
+        self.assertEqual([], b.loop.pending())
+        b.loop.run_until(10.0)  # ACK_TIMEOUT and TRIAL long past
+        self.assertEqual(0, b.restarts)
+
+    def test_unplugged_during_probes(self):
+        b = Bridge()
+        b.link.offer([FAST])
+        b.link.on_ack(FAST)
+        b.unplugged = True
+        b.loop.run_until(linkspeed.SETTLE)  # first probe write fails
+        self.assertIsNone(b.link.ser)
+        self.assertEqual([], b.loop.pending())
+        b.loop.run_until(10.0)
+        self.assertEqual(0, b.restarts)
+
+    def test_fail_on_detached_link(self):
+        b = Bridge()
+        b.link.attach(None)
+        b.link.fail("late timer")
+        b.link.set_default()
+        self.assertEqual([], b.loop.pending())
+
+    def test_probe_frame_round_trips(self):
+        frame = protocol.encode_frame(protocol.MSG_PROBE, linkspeed.probe_payload(3))
+        self.assertEqual((protocol.MSG_PROBE, linkspeed.probe_payload(3)),
+                         protocol.decode_frame(frame[:-1]))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,74 @@
+// =============================================
+// HOST BENCHMARKS (pio run -e bench)
+// =============================================
+// Times firmware_v1's hot paths on Linux. The firmware source is compiled
+// into this file, so the cases call the real functions and state; the
+// shim's framebuffer stands in for the panel. Output format: HostBench.h.
+
+#include "../src/main.cpp"
+
+#include <BenchInputs.h>
+#include <HostBench.h>
+#include <host.h>
+
+#include <string>
+
+static void feedFrame(const uint8_t *p, size_t len) {
+  for (size_t i = 0; i < len; i++)
+    if (framer.push(p[i]) == TP_FRAME_BINARY)
+      parseBinaryFrame();
+}
+
+int host_bench_main(int argc, char **argv) {
+  if (!bench_begin(argc, argv, "v1"))
+    return 2;
+  setup();
+
+  // --- Telemetry parsing ---
+  std::string truncated = bench_json_truncated();
+  std::string oversized = bench_json_oversized(4096);
+  bench_run("json/realistic", 20000,
+            [] { parseSerialData(BENCH_JSON_TELEMETRY); },
+            sizeof(BENCH_JSON_TELEMETRY) - 1);
+  bench_run("json/oversized", 2000,
+            [&] { parseSerialData(oversized.c_str()); }, oversized.size());
+  bench_run("json/truncated", 20000,
+            [&] { parseSerialData(truncated.c_str()); }, truncated.size());
+  bench_run("json/wrong_types", 20000,
+            [] { parseSerialData(BENCH_JSON_WRONG_TYPES); },
+            sizeof(BENCH_JSON_WRONG_TYPES) - 1);
+  bench_run("binary/keyframe", 50000,
+            [] { feedFrame(BENCH_FRAME_KEYFRAME, sizeof(BENCH_FRAME_KEYFRAME)); },
+            sizeof(BENCH_FRAME_KEYFRAME));
+  bench_run("binary/delta", 50000,
+            [] { feedFrame(BENCH_FRAME_DELTA, sizeof(BENCH_FRAME_DELTA)); },
+            sizeof(BENCH_FRAME_DELTA));
+
+  // --- Touch: SPI burst, median and calibration ---
+  host_touch_set(true, 250, 180);
+  bench_run("touch/read", 20000, [] {
+    int x, y;
+    getTouch(x, y);
+  });
+  host_touch_set(false, 250, 180);
+
+  // --- Label formatting ---
+  parseSerialData(BENCH_JSON_TELEMETRY);
+  bench_run("format/status", 20000, [] {
+    StatusView v;
+    formatStatus(v);
+  });
+  bench_run("format/rate", 100000, [] {
+    char buf[12];
+    tp_format_rate(stats.uplink.rx, buf, sizeof(buf));
+  });
+
+  // --- Status tab into the framebuffer ---
+  bench_run("render/status_full", 500, [] { drawStatusTab(); });
+  bench_run("render/status_cpu", 2000, [] {
+    stats.cpu = stats.cpu == 12.5f ? 40.0f : 12.5f;
+    updateStatusTab();
+  });
+
+  return bench_end();
+}
@@ -1,7 +1,12 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <PerfCounters.h>
 #include <SPI.h>
 #include <TFT_eSPI.h>
+#include <TravelActions.h>
+#include <TravelProto.h>
+#include <TravelProtoJson.h>
+#include <Xpt2046.h>
 
 // =============================================
 // PIN CONFIGURATION (ESP32-2432S028)
@@ -12,6 +17,13 @@
 #define TP_OUT 39
 #define TP_IRQ 36
 
+// Raw XPT2046 range across the panel (screen X follows raw Y)
+#define TOUCH_RAW_X_MIN 300
+#define TOUCH_RAW_X_MAX 3700
+#define TOUCH_RAW_Y_MIN 200
+#define TOUCH_RAW_Y_MAX 3800
+#define TOUCH_SAMPLES 3 // X/Y samples per read, median taken
+
 // =============================================
 // COLORS
 // =============================================
@@ -29,11 +41,9 @@
 #define COLOR_TAB_ACTIVE COLOR_ACCENT
 #define COLOR_TAB_INACTIVE 0x3186
 
-#define COLOR_BTN_ORANGE 0xFC00
+// Dialog buttons; the action buttons' colors come from tp_actions[]
 #define COLOR_BTN_RED 0xD000
-#define COLOR_BTN_DKRED 0x8000
 #define COLOR_BTN_GREEN 0x0640
-#define COLOR_BTN_YELLOW 0xF5A0
 
 // =============================================
 // LAYOUT
@@ -52,19 +62,12 @@
 // =============================================
 TFT_eSPI tft = TFT_eSPI();
 SPIClass touchSPI(VSPI);
+Xpt2046 touch(touchSPI, TP_CS, TP_IRQ);
 
 int currentTab = 0;
 
-// System stats
-float cpuPercent = 0;
-int ramTotal = 0, ramUsed = 0;
-float ramPercent = 0;
-int diskTotal = 0, diskUsed = 0;
-float diskPercent = 0;
-float temperature = 0;
-String ipWlan0 = "N/A";
-String ipWlan1 = "N/A";
-int uptimeSecs = 0;
+// System stats (merged from full and delta telemetry)
+tp_telemetry stats;
 bool dataReceived = false;
 
 // Touch
@@ -73,80 +76,105 @@ const unsigned long TOUCH_DEBOUNCE = 300;
 
 // Confirmation dialog
 int pendingButtonIdx = -1; // -1 = no dialog, 0-6 = which button
-unsigned long confirmFeedbackTime = 0;
-bool showSentFeedback = false;
+
+// Command progress overlay (see JOB OVERLAY)
+const char *jobAction = NULL; // action being tracked, NULL = no overlay
+bool jobAcked = false;        // the bridge reported on it
+bool jobFinished = false;
+unsigned long jobOverlayTime = 0; // last overlay change
 
 // Serial
-String serialBuffer = "";
+TpFramer framer;
+bool bridgeTakesFrames = false; // bridge hello offered binary commands
+TpLink serialLink;              // negotiated baud rate (see LINK SPEED)
+TpTracer tracer;                // stamps of a tracing bridge
+tp_trace trace;                 // ...of the telemetry being shown
+bool traceDue = false;          // acknowledge it after the repaint
 
 // =============================================
 // TOUCH
 // =============================================
-uint16_t touchReadChannel(uint8_t cmd) {
-  touchSPI.beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-  digitalWrite(TP_CS, LOW);
-  touchSPI.transfer(cmd);
-  uint8_t hi = touchSPI.transfer(0);
-  uint8_t lo = touchSPI.transfer(0);
-  digitalWrite(TP_CS, HIGH);
-  touchSPI.endTransaction();
-  return ((hi << 8) | lo) >> 3;
-}
-
-void touchPowerDown() {
-  touchSPI.beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-  digitalWrite(TP_CS, LOW);
-  touchSPI.transfer(0x80);
-  touchSPI.transfer(0);
-  touchSPI.transfer(0);
-  digitalWrite(TP_CS, HIGH);
-  touchSPI.endTransaction();
-}
-
 bool getTouch(int &x, int &y) {
-  if (digitalRead(TP_IRQ) != LOW)
+  if (!touch.touched())
     return false;
-  uint16_t z1 = touchReadChannel(0xB1);
-  uint16_t z2 = touchReadChannel(0xC1);
-  int z = z1 + 4095 - z2;
-  if (z > 400) {
-    uint16_t rawX = touchReadChannel(0xD1);
-    uint16_t rawY = touchReadChannel(0x91);
-    touchPowerDown();
-    x = map(rawY, 200, 3800, 0, 320);
-    y = map(rawX, 300, 3700, 0, 240);
-    x = constrain(x, 0, 319);
-    y = constrain(y, 0, 239);
-    return true;
-  }
-  touchPowerDown();
-  return false;
+  PerfTimer timer(PERF_TOUCH);
+  return touch.read(x, y);
 }
 
+// =============================================
+// STATIC LABELS
+// =============================================
+// Fixed strings, measured once in setup() so layout code never calls
+// textWidth() on them again
+enum StaticLabelId {
+  LBL_CPU,
+  LBL_RAM,
+  LBL_DSK,
+  LBL_AP,
+  LBL_WAN,
+  LBL_WAITING,
+  LBL_STATUS,
+  LBL_CONTROL,
+  LBL_CONFIRM,
+  LBL_YES,
+  LBL_NO,
+  LBL_COUNT
+};
+
+struct StaticLabel {
+  const char *text;
+  uint8_t font;
+  int16_t w; // px, set by measureStaticLabels()
+};
+
+StaticLabel staticLabels[LBL_COUNT] = {
+    {"CPU", FONT_SM},      {"RAM", FONT_SM},
+    {"DSK", FONT_SM},      {"AP ", FONT_SM},
+    {"WAN ", FONT_SM},     {"Waiting for Pi...", FONT_LG},
+    {"STATUS", FONT_LG},   {"CONTROL", FONT_LG},
+    {"Confirm?", FONT_LG}, {"YES", FONT_LG},
+    {"NO", FONT_LG},
+};
+
+
 // =============================================
 // DRAWING HELPERS
 // =============================================
-void drawProgressBar(int x, int y, int w, int h, float percent,
+// Draws on the panel or into a sprite; fillW is the bar fill in px
+void drawProgressBar(TFT_eSPI &gfx, int x, int y, int w, int h, int fillW,
                      uint16_t barColor) {
-  tft.fillRoundRect(x, y, w, h, 4, COLOR_BAR_BG);
-  int fillW = (int)((w - 2) * (percent / 100.0));
+  gfx.fillRoundRect(x, y, w, h, 4, COLOR_BAR_BG);
   if (fillW > 0) {
-    tft.fillRoundRect(x + 1, y + 1, fillW, h - 2, 3, barColor);
+    gfx.fillRoundRect(x + 1, y + 1, fillW, h - 2, 3, barColor);
   }
 }
 
-// Draw centered text button using Font 2
-void drawButton(int x, int y, int w, int h, const char *label, uint16_t color) {
+// Draw centered text button using Font 4; labelW is the label's width
+void drawButton(int x, int y, int w, int h, const char *label, int labelW,
+                uint16_t color) {
   tft.fillRoundRect(x, y, w, h, 6, color);
   tft.setTextFont(FONT_LG);
   tft.setTextSize(1);
-  int tw = tft.textWidth(label);
   int th = tft.fontHeight();
   tft.setTextColor(TFT_WHITE);
-  tft.setCursor(x + (w - tw) / 2, y + (h - th) / 2);
+  tft.setCursor(x + (w - labelW) / 2, y + (h - th) / 2);
   tft.print(label);
 }
 
+void drawButton(int x, int y, int w, int h, StaticLabelId label,
+                uint16_t color) {
+  drawButton(x, y, w, h, staticLabels[label].text, staticLabels[label].w,
+             color);
+}
+
+// buf must hold 16 chars
+const char *formatIp(const uint8_t ip[4], char *buf) {
+  if (!tp_ip_valid(ip))
+    return "N/A";
+  snprintf(buf, 16, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return buf;
+}
+
 bool isButtonPressed(int touchX, int touchY, int bx, int by, int bw, int bh) {
   return (touchX >= bx && touchX <= bx + bw && touchY >= by &&
           touchY <= by + bh);
@@ -159,22 +187,23 @@ void drawTabBar() {
   int tabW = SCREEN_W / 2;
   int tabY = SCREEN_H - TAB_BAR_H;
 
+  const StaticLabel &status = staticLabels[LBL_STATUS];
+  const StaticLabel &control = staticLabels[LBL_CONTROL];
+
   // Status tab
   tft.fillRect(0, tabY, tabW, TAB_BAR_H,
                currentTab == 0 ? COLOR_TAB_ACTIVE : COLOR_TAB_INACTIVE);
   tft.setTextFont(FONT_LG);
   tft.setTextSize(1);
   tft.setTextColor(TFT_WHITE);
-  int tw = tft.textWidth("STATUS");
-  tft.setCursor((tabW - tw) / 2, tabY + 6);
-  tft.print("STATUS");
+  tft.setCursor((tabW - status.w) / 2, tabY + 6);
+  tft.print(status.text);
 
   // Controls tab
   tft.fillRect(tabW, tabY, tabW, TAB_BAR_H,
                currentTab == 1 ? COLOR_TAB_ACTIVE : COLOR_TAB_INACTIVE);
-  tw = tft.textWidth("CONTROL");
-  tft.setCursor(tabW + (tabW - tw) / 2, tabY + 6);
-  tft.print("CONTROL");
+  tft.setCursor(tabW + (tabW - control.w) / 2, tabY + 6);
+  tft.print(control.text);
 
   // Separator
   tft.drawFastVLine(tabW, tabY, TAB_BAR_H, COLOR_BG);
@@ -183,120 +212,282 @@ void drawTabBar() {
 // =============================================
 // STATUS TAB
 // =============================================
+// Band compositing: the tab is split into horizontal bands (one per
+// meter, temperature/uptime, network). A band whose values changed is
+// composed off-screen in `band`, labels included, and pushed to the panel
+// in a single transfer, so the panel never shows a half-drawn value and
+// each update is a few large SPI writes instead of many small ones. If the
+// sprite can't be allocated, bands are drawn straight onto the panel
+// instead: same layout, but values flicker while they are redrawn.
+// drawStatusTab() paints the background and divider once; afterwards
+// updateStatusTab() only recomposes the bands that differ from `shown`.
+
+// Layout rows (FONT_SM rows are 16px, FONT_LG 26px)
+#define ST_LABEL_X 4
+#define ST_BAR_X 52
+#define ST_BAR_W 200
+#define ST_BAR_H 16
+#define ST_VAL_X 258
+#define ST_CPU_Y 4
+#define ST_RAM_Y 28
+#define ST_DSK_Y 64
+#define ST_TEMP_Y 102
+#define ST_DIVIDER_Y 132
+#define ST_NET_Y 138
+#define ST_RATE_Y 160 // uplink row, hotspot row
+
+// Band heights; BAND_H is the tallest, and the size of the sprite
+#define ST_METER_H 16        // label, bar, value
+#define ST_METER_DETAIL_H 32 // plus a used / total line under the bar
+#define ST_TEMP_H 26
+#define ST_NET_H 16
+#define ST_RATE_H 32
+#define BAND_H 32
+
+// Set to 1 to print {"draw":{...}} pixel counts after every status update
+#ifndef REPORT_DRAW_STATS
+#define REPORT_DRAW_STATS 0
+#endif
+
+// Everything the status tab shows, formatted
+struct StatusView {
+  int16_t cpuFill, ramFill, diskFill; // bar fill, px
+  char cpu[8], ram[8], ramDetail[24];
+  char disk[8], diskDetail[24];
+  uint16_t tempColor;
+  char temp[12], uptime[16];
+  char ap[16], wan[16];
+  char wanRate[32], apRate[32];   // "rx 1.2 MB/s  tx 80 KB/s"
+  char wanDrops[16], apDrops[16]; // empty while nothing is dropped
+};
+
+StatusView shown;
+bool statusLayoutDrawn = false; // background painted, `shown` matches it
+uint32_t framePixels = 0;       // pixels pushed by the current update
+
+// SCREEN_W x BAND_H off-screen buffer (20 KB), allocated in setup()
+TFT_eSprite band = TFT_eSprite(&tft);
+
+// Where bands are composed: `band`, or &tft when it couldn't be allocated
+TFT_eSPI *bandGfx = &band;
+int bandY = 0; // row of the current band's top in bandGfx
+
+void fillCounted(int x, int y, int w, int h, uint16_t color) {
+  if (w <= 0 || h <= 0)
+    return;
+  tft.fillRect(x, y, w, h, color);
+  framePixels += w * h;
+}
+
+// Clear h rows for the band at panel row y; band coordinates start at 0
+void beginBand(int y, int h) {
+  bandY = bandGfx == &tft ? y : 0;
+  bandGfx->fillRect(0, bandY, SCREEN_W, h, COLOR_BG);
+}
+
+// Send the top h rows of the band to panel row y
+void pushBand(int y, int h) {
+  if (bandGfx == &band)
+    band.pushSprite(0, y, 0, 0, SCREEN_W, h);
+  framePixels += SCREEN_W * h;
+}
+
+void bandText(int x, int y, uint8_t font, uint16_t color, const char *s) {
+  bandGfx->setTextFont(font);
+  bandGfx->setTextColor(color, COLOR_BG);
+  bandGfx->setCursor(x, bandY + y);
+  bandGfx->print(s);
+}
+
+int bandTextWidth(const char *s, uint8_t font) {
+  bandGfx->setTextFont(font);
+  return bandGfx->textWidth(s);
+}
+
+int barFill(float percent) {
+  return constrain((int)((ST_BAR_W - 2) * (percent / 100.0)), 0, ST_BAR_W - 2);
+}
+
+// Label, bar and value, with an optional detail line under the bar
+void drawMeterBand(int y, StaticLabelId label, uint16_t color, int fill,
+                   const char *value, const char *detail) {
+  int h = detail ? ST_METER_DETAIL_H : ST_METER_H;
+  beginBand(y, h);
+  bandText(ST_LABEL_X, 0, FONT_SM, color, staticLabels[label].text);
+  drawProgressBar(*bandGfx, ST_BAR_X, bandY, ST_BAR_W, ST_BAR_H, fill, color);
+  bandText(ST_VAL_X, 0, FONT_SM, COLOR_TEXT, value);
+  if (detail)
+    bandText(ST_BAR_X, ST_BAR_H, FONT_SM, COLOR_DIM, detail);
+  pushBand(y, h);
+}
+
+// Temperature left, uptime right-aligned
+void drawTempBand(const StatusView &v) {
+  beginBand(ST_TEMP_Y, ST_TEMP_H);
+  bandText(ST_LABEL_X, 0, FONT_LG, v.tempColor, v.temp);
+  bandText(SCREEN_W - bandTextWidth(v.uptime, FONT_LG) - 4, 0, FONT_LG,
+           COLOR_DIM, v.uptime);
+  pushBand(ST_TEMP_Y, ST_TEMP_H);
+}
+
+void drawNetBand(const StatusView &v) {
+  const StaticLabel &ap = staticLabels[LBL_AP];
+  const StaticLabel &wan = staticLabels[LBL_WAN];
+  beginBand(ST_NET_Y, ST_NET_H);
+  bandText(ST_LABEL_X, 0, FONT_SM, COLOR_ACCENT, ap.text);
+  bandText(ST_LABEL_X + ap.w, 0, FONT_SM, COLOR_TEXT, v.ap);
+  bandText(SCREEN_W / 2, 0, FONT_SM, COLOR_ACCENT, wan.text);
+  bandText(SCREEN_W / 2 + wan.w, 0, FONT_SM, COLOR_TEXT, v.wan);
+  pushBand(ST_NET_Y, ST_NET_H);
+}
+
+void drawRateRow(int y, const StaticLabel &label, const char *rate,
+                 const char *drops) {
+  // Values line up after the wider of the two labels
+  int x = ST_LABEL_X + staticLabels[LBL_WAN].w;
+  bandText(ST_LABEL_X, y, FONT_SM, COLOR_ACCENT, label.text);
+  bandText(x, y, FONT_SM, COLOR_TEXT, rate);
+  if (drops[0])
+    bandText(SCREEN_W - bandTextWidth(drops, FONT_SM) - 4, y, FONT_SM,
+             COLOR_TEMP_WARN, drops);
+}
+
+// Uplink and hotspot throughput
+void drawRateBand(const StatusView &v) {
+  beginBand(ST_RATE_Y, ST_RATE_H);
+  drawRateRow(0, staticLabels[LBL_WAN], v.wanRate, v.wanDrops);
+  drawRateRow(ST_RATE_H / 2, staticLabels[LBL_AP], v.apRate, v.apDrops);
+  pushBand(ST_RATE_Y, ST_RATE_H);
+}
+
+void reportDrawStats(bool full) {
+  perf_frame(framePixels * 2);
+#if REPORT_DRAW_STATS
+  Serial.printf("{\"draw\":{\"px\":%lu,\"full\":%d}}\n",
+                (unsigned long)framePixels, full);
+#endif
+}
+
+void formatTraffic(const tp_traffic &t, char *rate, size_t rateLen,
+                   char *drops, size_t dropsLen) {
+  char rx[12], tx[12];
+  snprintf(rate, rateLen, "rx %s  tx %s", tp_format_rate(t.rx, rx, sizeof(rx)),
+           tp_format_rate(t.tx, tx, sizeof(tx)));
+  if (t.drops > 0)
+    snprintf(drops, dropsLen, "%.1f drop/s", t.drops);
+  else
+    drops[0] = '\0';
+}
+
+void formatStatus(StatusView &v) {
+  v.cpuFill = barFill(stats.cpu);
+  snprintf(v.cpu, sizeof(v.cpu), "%.0f%%", stats.cpu);
+
+  v.ramFill = barFill(stats.ram_percent);
+  snprintf(v.ram, sizeof(v.ram), "%.0f%%", stats.ram_percent);
+  snprintf(v.ramDetail, sizeof(v.ramDetail), "%u / %u MB", stats.ram_used,
+           stats.ram_total);
+
+  v.diskFill = barFill(stats.disk_percent);
+  snprintf(v.disk, sizeof(v.disk), "%.0f%%", stats.disk_percent);
+  snprintf(v.diskDetail, sizeof(v.diskDetail), "%u / %u GB", stats.disk_used,
+           stats.disk_total);
+
+  v.tempColor = COLOR_TEMP_OK;
+  if (stats.temp > 70)
+    v.tempColor = COLOR_TEMP_HOT;
+  else if (stats.temp > 55)
+    v.tempColor = COLOR_TEMP_WARN;
+  snprintf(v.temp, sizeof(v.temp), "%.1f'C", stats.temp);
+  snprintf(v.uptime, sizeof(v.uptime), "UP %dh%dm", (int)(stats.uptime / 3600),
+           (int)(stats.uptime % 3600 / 60));
+
+  char buf[16];
+  strcpy(v.ap, formatIp(stats.ip[TP_IF_WLAN0], buf));
+  strcpy(v.wan, formatIp(stats.ip[TP_IF_WLAN1], buf));
+
+  formatTraffic(stats.uplink, v.wanRate, sizeof(v.wanRate), v.wanDrops,
+                sizeof(v.wanDrops));
+  formatTraffic(stats.hotspot, v.apRate, sizeof(v.apRate), v.apDrops,
+                sizeof(v.apDrops));
+}
+
+static bool same(const char *a, const char *b) { return strcmp(a, b) == 0; }
+
+// Recompose the bands whose values differ from `shown` (all if full)
+void updateStatusFields(bool full) {
+  StatusView v;
+  formatStatus(v);
+  const StatusView &o = shown;
+
+  if (full || v.cpuFill != o.cpuFill || !same(v.cpu, o.cpu))
+    drawMeterBand(ST_CPU_Y, LBL_CPU, COLOR_CPU, v.cpuFill, v.cpu, NULL);
+  if (full || v.ramFill != o.ramFill || !same(v.ram, o.ram) ||
+      !same(v.ramDetail, o.ramDetail))
+    drawMeterBand(ST_RAM_Y, LBL_RAM, COLOR_RAM, v.ramFill, v.ram,
+                  v.ramDetail);
+  if (full || v.diskFill != o.diskFill || !same(v.disk, o.disk) ||
+      !same(v.diskDetail, o.diskDetail))
+    drawMeterBand(ST_DSK_Y, LBL_DSK, COLOR_DISK, v.diskFill, v.disk,
+                  v.diskDetail);
+  if (full || v.tempColor != o.tempColor || !same(v.temp, o.temp) ||
+      !same(v.uptime, o.uptime))
+    drawTempBand(v);
+  if (full || !same(v.ap, o.ap) || !same(v.wan, o.wan))
+    drawNetBand(v);
+  if (full || !same(v.wanRate, o.wanRate) || !same(v.apRate, o.apRate) ||
+      !same(v.wanDrops, o.wanDrops) || !same(v.apDrops, o.apDrops))
+    drawRateBand(v);
+
+  shown = v;
+}
+
+// Full repaint: background, divider, then every band
 void drawStatusTab() {
-  tft.fillRect(0, 0, SCREEN_W, CONTENT_H, COLOR_BG);
+  framePixels = 0;
+  fillCounted(0, 0, SCREEN_W, CONTENT_H, COLOR_BG);
 
   if (!dataReceived) {
-    tft.setTextFont(FONT_LG);
+    const StaticLabel &l = staticLabels[LBL_WAITING];
+    tft.setTextFont(l.font);
     tft.setTextColor(COLOR_DIM);
-    int tw = tft.textWidth("Waiting for Pi...");
-    tft.setCursor((SCREEN_W - tw) / 2, 80);
-    tft.print("Waiting for Pi...");
+    tft.setCursor((SCREEN_W - l.w) / 2, 80);
+    tft.print(l.text);
+    framePixels += l.w * tft.fontHeight();
+    statusLayoutDrawn = false;
+    reportDrawStats(true);
     return;
   }
 
-  char buf[32];
-  int y = 4;
-  int labelX = 4;
-  int barX = 52;
-  int barW = 200;
-  int barH = 16;
-  int valX = 258;
-
-  // --- CPU ---
-  tft.setTextFont(FONT_SM);
-  tft.setTextColor(COLOR_CPU);
-  tft.setCursor(labelX, y);
-  tft.print("CPU");
-  drawProgressBar(barX, y, barW, barH, cpuPercent, COLOR_CPU);
-  tft.setTextColor(COLOR_TEXT);
-  snprintf(buf, sizeof(buf), "%.0f%%", cpuPercent);
-  tft.setCursor(valX, y);
-  tft.print(buf);
-  y += 24;
-
-  // --- RAM ---
-  tft.setTextColor(COLOR_RAM);
-  tft.setCursor(labelX, y);
-  tft.print("RAM");
-  drawProgressBar(barX, y, barW, barH, ramPercent, COLOR_RAM);
-  tft.setTextColor(COLOR_TEXT);
-  snprintf(buf, sizeof(buf), "%.0f%%", ramPercent);
-  tft.setCursor(valX, y);
-  tft.print(buf);
-  y += 16;
-  tft.setTextColor(COLOR_DIM);
-  tft.setCursor(barX, y);
-  snprintf(buf, sizeof(buf), "%d / %d MB", ramUsed, ramTotal);
-  tft.print(buf);
-  y += 20;
-
-  // --- DISK ---
-  tft.setTextColor(COLOR_DISK);
-  tft.setCursor(labelX, y);
-  tft.print("DSK");
-  drawProgressBar(barX, y, barW, barH, diskPercent, COLOR_DISK);
-  tft.setTextColor(COLOR_TEXT);
-  snprintf(buf, sizeof(buf), "%.0f%%", diskPercent);
-  tft.setCursor(valX, y);
-  tft.print(buf);
-  y += 16;
-  tft.setTextColor(COLOR_DIM);
-  tft.setCursor(barX, y);
-  snprintf(buf, sizeof(buf), "%d / %d GB", diskUsed, diskTotal);
-  tft.print(buf);
-  y += 22;
-
-  // --- TEMP ---
-  uint16_t tempColor = COLOR_TEMP_OK;
-  if (temperature > 70)
-    tempColor = COLOR_TEMP_HOT;
-  else if (temperature > 55)
-    tempColor = COLOR_TEMP_WARN;
-
-  tft.setTextFont(FONT_LG);
-  tft.setTextColor(tempColor);
-  snprintf(buf, sizeof(buf), "%.1f'C", temperature);
-  tft.setCursor(labelX, y);
-  tft.print(buf);
-
-  // Uptime on same line, right-aligned
-  int hours = uptimeSecs / 3600;
-  int mins = (uptimeSecs % 3600) / 60;
-  snprintf(buf, sizeof(buf), "UP %dh%dm", hours, mins);
-  tft.setTextColor(COLOR_DIM);
-  int tw = tft.textWidth(buf);
-  tft.setCursor(SCREEN_W - tw - 4, y);
-  tft.print(buf);
-  y += 30;
-
   // --- Divider ---
-  tft.drawFastHLine(4, y, SCREEN_W - 8, COLOR_TAB_INACTIVE);
-  y += 6;
+  tft.drawFastHLine(4, ST_DIVIDER_Y, SCREEN_W - 8, COLOR_TAB_INACTIVE);
+  framePixels += SCREEN_W - 8;
 
-  // --- Network ---
-  tft.setTextFont(FONT_SM);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.setCursor(labelX, y);
-  tft.print("AP ");
-  tft.setTextColor(COLOR_TEXT);
-  tft.print(ipWlan0);
+  statusLayoutDrawn = true;
+  updateStatusFields(true);
+  reportDrawStats(true);
+}
 
-  tft.setTextColor(COLOR_ACCENT);
-  tft.setCursor(SCREEN_W / 2, y);
-  tft.print("WAN ");
-  tft.setTextColor(COLOR_TEXT);
-  tft.print(ipWlan1);
+// Incremental repaint after new telemetry
+void updateStatusTab() {
+  if (!statusLayoutDrawn) {
+    drawStatusTab();
+    return;
+  }
+  framePixels = 0;
+  updateStatusFields(false);
+  reportDrawStats(false);
 }
 
 // =============================================
 // CONTROLS TAB
 // =============================================
+// One button per entry of tp_actions[] (LCD/actions/actions.json), two
+// per row in table order
 struct Button {
   int x, y, w, h;
-  const char *label;
-  const char *action;
-  uint16_t color;
+  const tp_action *action;
+  int16_t labelW; // set by layoutButtons()
 };
 
 const int BTN_W = 148;
@@ -304,37 +495,49 @@ const int BTN_H = 42;
 const int BTN_PAD = 8;
 const int BTN_X1 = 4;
 const int BTN_X2 = 168;
+const int NUM_BUTTONS = TP_ACTION_COUNT;
 
-Button buttons[] = {
-    {BTN_X1, 6, BTN_W, BTN_H, "Reset Net", "reset_network", COLOR_BTN_ORANGE},
-    {BTN_X2, 6, BTN_W, BTN_H, "FW Strict", "fw_strict", COLOR_BTN_RED},
-    {BTN_X1, 6 + (BTN_H + BTN_PAD), BTN_W, BTN_H, "FW Maint", "fw_maint",
-     COLOR_BTN_YELLOW},
-    {BTN_X2, 6 + (BTN_H + BTN_PAD), BTN_W, BTN_H, "Start SMB", "start_smb",
-     COLOR_BTN_GREEN},
-    {BTN_X1, 6 + 2 * (BTN_H + BTN_PAD), BTN_W, BTN_H, "Stop SMB", "stop_smb",
-     COLOR_BTN_RED},
-    {BTN_X2, 6 + 2 * (BTN_H + BTN_PAD), BTN_W, BTN_H, "Reboot", "reboot",
-     COLOR_BTN_ORANGE},
-    {BTN_X1, 6 + 3 * (BTN_H + BTN_PAD), BTN_W, BTN_H, "Shutdown", "shutdown",
-     COLOR_BTN_DKRED},
-};
-const int NUM_BUTTONS = 7;
+static_assert(6 + (NUM_BUTTONS - 1) / 2 * (BTN_H + BTN_PAD) + BTN_H <=
+                  CONTENT_H,
+              "more actions than the Controls tab has room for");
 
-void drawControlsTab() {
-  tft.fillRect(0, 0, SCREEN_W, CONTENT_H, COLOR_BG);
+Button buttons[NUM_BUTTONS];
+
+void layoutButtons() {
+  tft.setTextFont(FONT_LG);
   for (int i = 0; i < NUM_BUTTONS; i++) {
-    drawButton(buttons[i].x, buttons[i].y, buttons[i].w, buttons[i].h,
-               buttons[i].label, buttons[i].color);
+    Button &b = buttons[i];
+    b.x = i % 2 ? BTN_X2 : BTN_X1;
+    b.y = 6 + i / 2 * (BTN_H + BTN_PAD);
+    b.w = BTN_W;
+    b.h = BTN_H;
+    b.action = &tp_actions[i];
+    b.labelW = tft.textWidth(b.action->label);
   }
 }
 
-void sendCommand(const char *action) {
-  JsonDocument doc;
-  doc["action"] = action;
-  String json;
-  serializeJson(doc, json);
-  Serial.println(json);
+void measureStaticLabels() {
+  for (int i = 0; i < LBL_COUNT; i++) {
+    tft.setTextFont(staticLabels[i].font);
+    staticLabels[i].w = tft.textWidth(staticLabels[i].text);
+  }
+}
+
+void drawActionButton(const Button &b, uint16_t color) {
+  drawButton(b.x, b.y, b.w, b.h, b.action->label, b.labelW, color);
+}
+
+void drawControlsTab() {
+  tft.fillRect(0, 0, SCREEN_W, CONTENT_H, COLOR_BG);
+  for (int i = 0; i < NUM_BUTTONS; i++)
+    drawActionButton(buttons[i], buttons[i].action->rgb565);
+}
+
+// Fixed-size command, built on the stack; tap is micros() of the touch
+void sendCommand(const tp_action &action, uint32_t tap) {
+  uint8_t cmd[TP_COMMAND_MAX];
+  size_t n = tp_encode_command(action, bridgeTakesFrames, tap, cmd);
+  Serial.write(cmd, n);
 }
 
 // =============================================
@@ -350,7 +553,7 @@ void sendCommand(const char *action) {
 #define DBTN_YES_X (DIALOG_X + 20)
 #define DBTN_NO_X (DIALOG_X + DIALOG_W - DBTN_W - 20)
 
-void drawConfirmDialog(const char *label) {
+void drawConfirmDialog(const Button &btn) {
   // Dim background
   tft.fillRect(0, 0, SCREEN_W, SCREEN_H, 0x0841);
 
@@ -359,90 +562,243 @@ void drawConfirmDialog(const char *label) {
   tft.drawRoundRect(DIALOG_X, DIALOG_Y, DIALOG_W, DIALOG_H, 10, COLOR_ACCENT);
 
   // Title: "Confirm?"
+  const StaticLabel &title = staticLabels[LBL_CONFIRM];
   tft.setTextFont(FONT_LG);
   tft.setTextColor(COLOR_TEXT);
-  char title[40];
-  snprintf(title, sizeof(title), "Confirm?");
-  int tw = tft.textWidth(title);
-  tft.setCursor(DIALOG_X + (DIALOG_W - tw) / 2, DIALOG_Y + 14);
-  tft.print(title);
+  tft.setCursor(DIALOG_X + (DIALOG_W - title.w) / 2, DIALOG_Y + 14);
+  tft.print(title.text);
 
   // Action name
-  tft.setTextFont(FONT_LG);
   tft.setTextColor(COLOR_ACCENT);
-  tw = tft.textWidth(label);
-  tft.setCursor(DIALOG_X + (DIALOG_W - tw) / 2, DIALOG_Y + 48);
-  tft.print(label);
+  tft.setCursor(DIALOG_X + (DIALOG_W - btn.labelW) / 2, DIALOG_Y + 48);
+  tft.print(btn.action->label);
 
   // YES button
-  drawButton(DBTN_YES_X, DBTN_Y, DBTN_W, DBTN_H, "YES", COLOR_BTN_GREEN);
+  drawButton(DBTN_YES_X, DBTN_Y, DBTN_W, DBTN_H, LBL_YES, COLOR_BTN_GREEN);
   // NO button
-  drawButton(DBTN_NO_X, DBTN_Y, DBTN_W, DBTN_H, "NO", COLOR_BTN_RED);
+  drawButton(DBTN_NO_X, DBTN_Y, DBTN_W, DBTN_H, LBL_NO, COLOR_BTN_RED);
 }
 
-void showSentOverlay() {
-  int boxW = 180;
+// =============================================
+// JOB OVERLAY
+// =============================================
+// After YES the overlay shows "Sent!", then follows the bridge's job
+// updates for that action until a result has been up for JOB_RESULT_MS.
+// A bridge that sends no updates gets the old 1.5 s "Sent!" flash. Any
+// tap dismisses it.
+#define JOB_ACK_TIMEOUT_MS 1500
+#define JOB_RESULT_MS 2500
+
+void drawJobOverlay(const char *text) {
+  int boxW = 240;
   int boxH = 36;
   int boxX = (SCREEN_W - boxW) / 2;
   int boxY = (SCREEN_H - boxH) / 2;
   tft.fillRoundRect(boxX, boxY, boxW, boxH, 8, COLOR_ACCENT);
   tft.setTextFont(FONT_LG);
   tft.setTextColor(TFT_BLACK);
-  int tw = tft.textWidth("Sent!");
+  int tw = tft.textWidth(text);
   tft.setCursor(boxX + (boxW - tw) / 2, boxY + 6);
-  tft.print("Sent!");
+  tft.print(text);
+}
+
+bool jobOverlayVisible() {
+  return jobAction && currentTab == 1 && pendingButtonIdx < 0;
+}
+
+void openJobOverlay(const char *action) {
+  jobAction = action;
+  jobAcked = false;
+  jobFinished = false;
+  jobOverlayTime = millis();
+  drawJobOverlay("Sent!");
+}
+
+void closeJobOverlay() {
+  bool visible = jobOverlayVisible();
+  jobAction = NULL;
+  if (visible) {
+    drawTabBar();
+    drawControlsTab();
+  }
+}
+
+void handleJobUpdate(const tp_job &job) {
+  if (!jobAction || strcmp(job.action, jobAction) != 0)
+    return;
+  jobAcked = true;
+  jobFinished = tp_job_finished(job);
+  jobOverlayTime = millis();
+  char text[24];
+  if (jobOverlayVisible())
+    drawJobOverlay(tp_job_text(job, text, sizeof(text)));
+}
+
+// Send the command and follow its job (from the Controls tab)
+void runAction(const tp_action &action, uint32_t tap) {
+  sendCommand(action, tap);
+  drawTabBar();
+  drawControlsTab();
+  openJobOverlay(action.name);
+}
+
+void expireJobOverlay() {
+  if (!jobAction)
+    return;
+  unsigned long shown = millis() - jobOverlayTime;
+  if (jobAcked ? jobFinished && shown > JOB_RESULT_MS
+               : shown > JOB_ACK_TIMEOUT_MS)
+    closeJobOverlay();
+}
+
+// =============================================
+// SERIAL PROTOCOL
+// =============================================
+// Answer the bridge's hello so it switches to binary telemetry
+void sendHello() {
+  Serial.printf("{\"hello\":\"travel-lcd\",\"fw\":\"v1\",\"proto\":%d,"
+                "\"delta\":1,\"trace\":1,\"baud\":" TP_BAUD_RATES_JSON
+                "}\n",
+                TP_VERSION);
 }
 
 // =============================================
-// JSON PARSING
+// LINK SPEED
 // =============================================
-void parseSerialData(const String &line) {
+// Acknowledge at the old rate, then switch (see TpLink)
+void handleBaudOffer(uint32_t rate) {
+  bool ok = serialLink.offer(rate, millis(), framer.dropped());
+  Serial.printf("{\"baud\":%lu}\n", ok ? (unsigned long)rate : 0UL);
+  if (ok) {
+    Serial.flush();
+    Serial.updateBaudRate(rate);
+  }
+}
+
+void echoProbe() {
+  size_t len = framer.payloadLength();
+  if (len > TP_PROBE_MAX)
+    return;
+  uint8_t out[TP_FRAME_OUT(TP_PROBE_MAX)];
+  Serial.write(out, tp_encode_frame(TP_MSG_PROBE, framer.payload(), len, out));
+  serialLink.probe();
+}
+
+// Trial ran out or too many bad frames: back to the default rate
+void checkLink() {
+  uint32_t rate = serialLink.poll(millis(), framer.dropped());
+  if (rate) {
+    Serial.flush();
+    Serial.updateBaudRate(rate);
+    sendHello();
+  }
+}
+
+// Tell a tracing bridge the stamped telemetry is on the panel, or that
+// there was nothing to draw (see LATENCY TRACE in TravelProto.h)
+void ackTelemetry(bool drawn) {
+  traceDue = false;
+  uint8_t out[TP_ACK_FRAME_SIZE];
+  Serial.write(out, tp_encode_ack(trace, drawn ? micros() : trace.rx,
+                                  drawn ? TP_ACK_DRAWN : TP_ACK_UNCHANGED,
+                                  out));
+}
+
+// Mark telemetry as received; the first sample changes everything
+uint16_t telemetryReceived(uint16_t changed) {
+  traceDue = tracer.take(micros(), trace);
+  if (!dataReceived) {
+    dataReceived = true;
+    return TP_F_ALL;
+  }
+  return changed;
+}
+
+// Returns the tp_field bits of the stats that changed
+uint16_t parseSerialData(const char *line) {
+  PerfTimer timer(PERF_PARSE);
   JsonDocument doc;
   DeserializationError err = deserializeJson(doc, line);
   if (err)
-    return;
+    return 0;
 
-  cpuPercent = doc["cpu"] | 0.0f;
-  JsonObject ram = doc["ram"];
-  if (ram) {
-    ramTotal = ram["total"] | 0;
-    ramUsed = ram["used"] | 0;
-    ramPercent = ram["percent"] | 0.0f;
+  if (!doc["hello"].isNull()) {
+    bridgeTakesFrames = (doc["cmd"] | 0) == 1;
+    sendHello();
+    return 0;
   }
-  JsonObject disk = doc["disk"];
-  if (disk) {
-    diskTotal = disk["total"] | 0;
-    diskUsed = disk["used"] | 0;
-    diskPercent = disk["percent"] | 0.0f;
+
+  if (doc["baud"].is<uint32_t>()) {
+    handleBaudOffer(doc["baud"].as<uint32_t>());
+    return 0;
   }
-  temperature = doc["temp"] | 0.0f;
-  JsonObject net = doc["net"];
-  if (net) {
-    ipWlan0 = net["wlan0"] | "N/A";
-    ipWlan1 = net["wlan1"] | "N/A";
+
+  tp_job job;
+  if (tp_parse_job(doc, job)) {
+    handleJobUpdate(job);
+    return 0;
   }
-  uptimeSecs = doc["uptime"] | 0;
-  dataReceived = true;
+
+  uint16_t changed;
+  if (!tp_merge_json(doc, stats, changed))
+    return 0;
+  return telemetryReceived(changed);
+}
+
+// Binary counterpart of parseSerialData()
+uint16_t parseBinaryFrame() {
+  PerfTimer timer(PERF_PARSE);
+  if (framer.type() == TP_MSG_PROBE) {
+    echoProbe();
+    return 0;
+  }
+  if (framer.type() == TP_MSG_STAMP) {
+    tracer.stamp(framer.payload(), framer.payloadLength());
+    return 0;
+  }
+  uint16_t changed;
+  if (!tp_decode_telemetry(framer.type(), framer.payload(),
+                           framer.payloadLength(), stats, changed))
+    return 0;
+  return telemetryReceived(changed);
+}
+
+void sendPerfReport() {
+  char link[48];
+  snprintf(link, sizeof(link), "\"link\":[%lu,%lu,%u]",
+           (unsigned long)serialLink.baud(), (unsigned long)framer.dropped(),
+           serialLink.fallbacks());
+  char line[240];
+  size_t n = perf_format_report(line, sizeof(line), millis(), link);
+  Serial.write((const uint8_t *)line, n);
 }
 
 // =============================================
 // SETUP
 // =============================================
 void setup() {
-  Serial.begin(115200);
+  Serial.begin(TP_BAUD_DEFAULT);
   delay(500);
   tft.init();
   tft.setRotation(1);
   tft.fillScreen(COLOR_BG);
 
-  pinMode(TP_CS, OUTPUT);
-  digitalWrite(TP_CS, HIGH);
-  pinMode(TP_IRQ, INPUT);
-  touchSPI.begin(TP_CLK, TP_OUT, TP_DIN, TP_CS);
-  touchPowerDown();
+  touch.begin(TP_CLK, TP_OUT, TP_DIN);
+  touch.setCalibration(xpt_calibration_swapped(TOUCH_RAW_X_MIN, TOUCH_RAW_X_MAX,
+                                               TOUCH_RAW_Y_MIN, TOUCH_RAW_Y_MAX,
+                                               SCREEN_W, SCREEN_H));
+  touch.setOversampling(TOUCH_SAMPLES);
+
+  measureStaticLabels();
+  layoutButtons();
+  if (!band.createSprite(SCREEN_W, BAND_H)) {
+    Serial.println("Status band: out of memory, drawing directly");
+    bandGfx = &tft;
+  }
 
   drawTabBar();
   drawStatusTab();
+  sendHello();
 }
 
 // =============================================
@@ -451,35 +807,44 @@ void setup() {
 void loop() {
   // Serial read
   while (Serial.available()) {
-    char c = Serial.read();
-    if (c == '\n') {
-      if (serialBuffer.length() > 0 && serialBuffer.charAt(0) == '{') {
-        parseSerialData(serialBuffer);
-        if (currentTab == 0)
-          drawStatusTab();
-      }
-      serialBuffer = "";
-    } else if (c != '\r') {
-      serialBuffer += c;
-      if (serialBuffer.length() > 512)
-        serialBuffer = "";
+    uint16_t changed = 0;
+    switch (framer.push(Serial.read())) {
+    case TP_FRAME_JSON:
+      changed = parseSerialData(framer.line());
+      break;
+    case TP_FRAME_BINARY:
+      changed = parseBinaryFrame();
+      break;
+    default:
+      break;
     }
+    // Nothing visible changed: skip the repaint
+    bool drawn = changed && currentTab == 0;
+    if (drawn) {
+      PerfTimer timer(PERF_RENDER);
+      updateStatusTab();
+    }
+    if (traceDue)
+      ackTelemetry(drawn);
   }
 
+  checkLink();
+  if (perf_report_due(millis()))
+    sendPerfReport();
+
   // Touch
   int tx, ty;
   if (getTouch(tx, ty) && (millis() - lastTouchTime > TOUCH_DEBOUNCE)) {
     lastTouchTime = millis();
+    uint32_t tapUs = micros(); // sent with a command it triggers
 
     // --- Confirmation dialog is active ---
     if (pendingButtonIdx >= 0) {
       // YES button
       if (isButtonPressed(tx, ty, DBTN_YES_X, DBTN_Y, DBTN_W, DBTN_H)) {
-        sendCommand(buttons[pendingButtonIdx].action);
+        const tp_action &action = *buttons[pendingButtonIdx].action;
         pendingButtonIdx = -1;
-        showSentOverlay();
-        showSentFeedback = true;
-        confirmFeedbackTime = millis();
+        runAction(action, tapUs);
       }
       // NO button
       else if (isButtonPressed(tx, ty, DBTN_NO_X, DBTN_Y, DBTN_W, DBTN_H)) {
@@ -495,6 +860,10 @@ void loop() {
         drawControlsTab();
       }
     }
+    // --- Command overlay: a tap just dismisses it ---
+    else if (jobOverlayVisible()) {
+      closeJobOverlay();
+    }
     // --- Normal UI ---
     else {
       int tabY = SCREEN_H - TAB_BAR_H;
@@ -517,11 +886,14 @@ void loop() {
             tft.fillRoundRect(buttons[i].x, buttons[i].y, buttons[i].w,
                               buttons[i].h, 6, TFT_WHITE);
             delay(80);
-            drawButton(buttons[i].x, buttons[i].y, buttons[i].w, buttons[i].h,
-                       buttons[i].label, buttons[i].color);
-            // Show confirmation dialog
-            pendingButtonIdx = i;
-            drawConfirmDialog(buttons[i].label);
+            drawActionButton(buttons[i], buttons[i].action->rgb565);
+            if (buttons[i].action->confirm) {
+              // Show confirmation dialog
+              pendingButtonIdx = i;
+              drawConfirmDialog(buttons[i]);
+            } else {
+              runAction(*buttons[i].action, tapUs);
+            }
             break;
           }
         }
@@ -529,10 +901,5 @@ void loop() {
     }
   }
 
-  // Clear "Sent!" feedback after 1.5s
-  if (showSentFeedback && millis() - confirmFeedbackTime > 1500) {
-    showSentFeedback = false;
-    drawTabBar();
-    drawControlsTab();
-  }
+  expireJobOverlay();
 }
@@ -8,9 +8,10 @@
 
 #include <stdint.h>
 
-/* Color depth: 16-bit (RGB565) matches TFT_eSPI */
+/* Color depth: 16-bit (RGB565) matches TFT_eSPI.
+ * Swapped so LVGL renders big-endian pixels the ST7789 takes as-is over DMA */
 #define LV_COLOR_DEPTH 16
-#define LV_COLOR_16_SWAP 0
+#define LV_COLOR_16_SWAP 1
 
 /* Memory */
 #define LV_MEM_CUSTOM 0
@@ -78,7 +79,7 @@
 /* Extra widgets */
 #define LV_USE_ANIMIMG 0
 #define LV_USE_CALENDAR 0
-#define LV_USE_CHART 0
+#define LV_USE_CHART 1
 #define LV_USE_COLORWHEEL 0
 #define LV_USE_IMGBTN 0
 #define LV_USE_KEYBOARD 0
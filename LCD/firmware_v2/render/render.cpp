@@ -0,0 +1,84 @@
+/* =============================================
+ * RENDER HARNESS (pio run -e render)
+ * =============================================
+ * Frame cost of firmware_v2's UI changes on Linux: the real build_ui()
+ * and LVGL, flushed through my_disp_flush into the shim's framebuffer.
+ * No tasks are started; the io_task / render_task hand-over is done
+ * inline. Cases and output: HostRender.h. */
+
+#include "../src/main.cpp"
+
+#include <BenchInputs.h>
+#include <HostRender.h>
+#include <host.h>
+
+/* What io_task and render_task do with one telemetry line */
+static void apply_telemetry(const char *json) {
+  update_stats(json);
+  show_stats(stats, pending_changed);
+  pending_changed = 0;
+}
+
+/* As if the tab's button was tapped: the History tab builds its chart */
+static void show_tab(uint16_t id) {
+  lv_tabview_set_act(tabview, id, LV_ANIM_OFF);
+  lv_event_send(tabview, LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+static void hide_confirm() {
+  lv_obj_add_flag(lv_obj_get_parent(confirm_box), LV_OBJ_FLAG_HIDDEN);
+}
+
+int host_bench_main(int argc, char **argv) {
+  if (!render_begin(argc, argv, "v2"))
+    return 2;
+  init_display();
+  build_ui();
+  apply_telemetry(BENCH_JSON_TELEMETRY);
+
+  /* Nothing changed: a refresh must not draw anything */
+  render_case("idle", [] {}, [] {});
+
+  /* Steady telemetry tick on the Status tab */
+  render_case("tick", [] { apply_telemetry(BENCH_JSON_TELEMETRY); },
+              [] { apply_telemetry(BENCH_JSON_TICK); });
+
+  /* Tab switches: a plain one, and one that builds the history chart */
+  render_case("tab_switch", [] { show_tab(0); }, [] { show_tab(2); });
+  render_case("tab_history", [] { show_tab(0); }, [] { show_tab(1); });
+  show_tab(0);
+
+  /* Theme switch from the Settings tab: restyles every object */
+  render_case("theme_toggle", [] { apply_theme(LV_THEME_DEFAULT_DARK); },
+              [] { apply_theme(!LV_THEME_DEFAULT_DARK); });
+  apply_theme(LV_THEME_DEFAULT_DARK);
+
+  /* Confirmation box over the Controls tab */
+  render_case("msgbox_open",
+              [] {
+                show_tab(2);
+                hide_confirm();
+              },
+              [] { confirm_open(tp_actions[0]); });
+  hide_confirm();
+
+  /* Backlight off: telemetry reaches the widgets but nothing is drawn */
+  render_case("tick_asleep",
+              [] {
+                if (display_on)
+                  display_sleep();
+                apply_telemetry(BENCH_JSON_TELEMETRY);
+              },
+              [] { apply_telemetry(BENCH_JSON_TICK); });
+
+  /* Touch wakes it: one full refresh with what changed meanwhile */
+  render_case("wake",
+              [] {
+                if (display_on)
+                  display_sleep();
+                apply_telemetry(BENCH_JSON_TICK);
+              },
+              [] { display_wake(); });
+
+  return render_end();
+}
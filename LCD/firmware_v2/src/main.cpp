@@ -1,7 +1,17 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <PerfCounters.h>
 #include <SPI.h>
+#include <SpscQueue.h>
 #include <TFT_eSPI.h>
+#include <TravelActions.h>
+#include <TravelProto.h>
+#include <TravelProtoJson.h>
+#include <Xpt2046.h>
+#include <atomic>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include <esp_sleep.h>
 #include <lvgl.h>
 
 /* =============================================
@@ -13,6 +23,13 @@
 #define TP_OUT 39
 #define TP_IRQ 36
 
+/* Raw XPT2046 range across the panel (screen X follows raw Y) */
+#define TOUCH_RAW_X_MIN 300
+#define TOUCH_RAW_X_MAX 3700
+#define TOUCH_RAW_Y_MIN 200
+#define TOUCH_RAW_Y_MAX 3800
+#define TOUCH_SAMPLES 3 /* X/Y samples per read, median taken */
+
 /* Backlight Control */
 #define TFT_BL 21
 static const unsigned long SCREEN_TIMEOUT = 15000; /* 15 seconds */
@@ -23,120 +40,423 @@ static bool display_on = true;
 static const uint16_t screenWidth = 320;
 static const uint16_t screenHeight = 240;
 
+/* Two DMA-capable draw buffers: LVGL renders into one band while the
+ * other is still being sent to the ST7789. LV_COLOR_16_SWAP makes LVGL
+ * render in the panel's byte order, so no per-pixel swap is needed. */
+#define DRAW_BUF_LINES 20
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[screenWidth * 10];
+DMA_ATTR static lv_color_t buf1[screenWidth * DRAW_BUF_LINES];
+DMA_ATTR static lv_color_t buf2[screenWidth * DRAW_BUF_LINES];
 
 TFT_eSPI tft = TFT_eSPI(); /* TFT instance */
 SPIClass touchSPI(VSPI);   /* Separate SPI bus for touch */
+Xpt2046 touch(touchSPI, TP_CS, TP_IRQ);
+
+/* =============================================
+ * TASKS
+ * =============================================
+ * render_task (RENDER_CORE) owns every LVGL call: timers, widgets and the
+ * display flush. io_task (IO_CORE) owns the UART and the touch controller:
+ * it frames and decodes telemetry and samples touch. The two only talk
+ * through lock-free SPSC queues, so parsing a large frame never costs a
+ * rendered frame or a tap.
+ *
+ * Neither task polls. io_task blocks until the UART RX callback or the
+ * TP_IRQ falling edge notifies it (and samples every IO_PERIOD_MS only
+ * while the panel is pressed, as PENIRQ does not signal the release).
+ * render_task sleeps until the next LVGL timer is due or io_task hands it
+ * something. With the backlight off, both idle and the link silent for
+ * LINK_QUIET_MS, the chip light-sleeps until a touch or UART activity. */
+#define RENDER_CORE 1
+#define IO_CORE 0
+#define RENDER_STACK 8192
+#define IO_STACK 6144
+#define RENDER_MAX_SLEEP_MS 1000 /* cap when no LVGL timer is pending */
+#define IO_PERIOD_MS 5 /* touch sampling interval while pressed */
+#define UART_WAKE_EDGES 3 /* RX edges that wake the chip from light sleep */
+/* No RX for longer than the bridge's keyframe interval (30 s): no bridge */
+#define LINK_QUIET_MS 45000
+
+/* Decoded telemetry handed from io_task to render_task */
+struct telemetry_msg {
+  tp_telemetry stats;
+  uint16_t changed; /* tp_field bits that differ from the previous msg */
+  bool traced;      /* trace: newest stamped update merged into it */
+  tp_trace trace;
+};
+
+/* Touch state change handed from io_task to render_task */
+struct touch_event {
+  bool pressed;
+  int16_t x, y;
+  uint32_t us; /* micros() when sampled */
+};
+
+static SpscQueue<telemetry_msg, 4> telemetry_queue;
+static SpscQueue<touch_event, 16> touch_queue;
+static SpscQueue<tp_job, 8> job_queue; /* bridge command progress */
+
+static TaskHandle_t render_task_handle = NULL;
+static TaskHandle_t io_task_handle = NULL;
+static std::atomic<bool> io_idle{false}; /* io_task blocked without timeout */
+static lv_indev_t *touch_indev = NULL;
+static std::atomic<bool> bridge_takes_frames{false}; /* set from its hello */
+
+/* Link speed (see TpLink): serial_link is io_task's; the rest is copied
+ * out for the perf report */
+static TpLink serial_link;
+static std::atomic<uint32_t> link_baud{TP_BAUD_DEFAULT};
+static std::atomic<uint32_t> link_errors{0}; /* framer drops since boot */
+static std::atomic<uint16_t> link_fallbacks{0};
+static std::atomic<bool> uart_woke{false}; /* light sleep ended by RX */
+static std::atomic<uint32_t> last_rx_ms{0};  /* millis() of the last RX */
+
+/* =============================================
+ * SERIAL INGEST
+ * =============================================
+ * The UART event task copies received bytes into rx_queue; io_task drains
+ * them into the framer. Complete frames are parsed in place from the
+ * framer's static buffer. */
+#define RX_QUEUE_SIZE 1024 /* bytes, power of two */
+
+static SpscQueue<uint8_t, RX_QUEUE_SIZE> rx_queue;
+static TpFramer framer; /* Serial frame assembler (JSON + binary) */
+
+/* Bump allocator over a static arena, reset before every parse, so
+ * deserializeJson never touches the heap. 4 KB holds a full telemetry
+ * object with room to spare. */
+#define JSON_ARENA_SIZE 4096
+
+class JsonArena : public ArduinoJson::Allocator {
+public:
+  void reset() { used_ = 0; }
+
+  void *allocate(size_t size) override {
+    size = align(size);
+    if (used_ + HDR + size > sizeof(pool_))
+      return nullptr;
+    uint8_t *p = pool_ + used_ + HDR;
+    set_size(p, size);
+    used_ += HDR + size;
+    return p;
+  }
+
+  void deallocate(void *) override {} /* freed wholesale by reset() */
+
+  void *reallocate(void *ptr, size_t size) override {
+    if (!ptr)
+      return allocate(size);
+    uint8_t *p = (uint8_t *)ptr;
+    size_t old = get_size(p);
+    size = align(size);
+    if (p + old == pool_ + used_) { /* last block: resize in place */
+      if (p - pool_ + size > sizeof(pool_))
+        return nullptr;
+      used_ = p - pool_ + size;
+      set_size(p, size);
+      return p;
+    }
+    if (size <= old)
+      return p;
+    void *q = allocate(size);
+    if (q)
+      memcpy(q, p, old);
+    return q;
+  }
+
+private:
+  static const size_t HDR = 8; /* size header, keeps 8-byte alignment */
+  static size_t align(size_t n) { return (n + 7) & ~(size_t)7; }
+  static size_t get_size(uint8_t *p) { return *(uint32_t *)(p - HDR); }
+  static void set_size(uint8_t *p, size_t n) { *(uint32_t *)(p - HDR) = n; }
+
+  alignas(8) uint8_t pool_[JSON_ARENA_SIZE];
+  size_t used_ = 0;
+};
+
+static JsonArena json_arena;
+
+/* Runs in the UART event task */
+void serial_rx_cb() {
+  while (Serial.available())
+    rx_queue.push((uint8_t)Serial.read());
+  if (io_task_handle)
+    xTaskNotifyGive(io_task_handle);
+}
+
+/* =============================================
+ * SERIAL OUTPUT
+ * =============================================
+ * Both tasks write to Serial. Every message goes out as one write under
+ * tx_lock, and the baud rate only changes while it is held, so messages
+ * never interleave or straddle a rate switch. */
+static SemaphoreHandle_t tx_lock = NULL; /* from setup(); none on the host
+                                            harnesses, which have no tasks */
+
+static void tx_hold() {
+  if (tx_lock)
+    xSemaphoreTake(tx_lock, portMAX_DELAY);
+}
+
+static void tx_release() {
+  if (tx_lock)
+    xSemaphoreGive(tx_lock);
+}
+
+static void serial_send(const void *data, size_t len) {
+  tx_hold();
+  Serial.write((const uint8_t *)data, len);
+  tx_release();
+}
+
+/* printf into a stack buffer, then one serial_send() */
+static void serial_printf(const char *fmt, ...)
+    __attribute__((format(printf, 1, 2)));
+static void serial_printf(const char *fmt, ...) {
+  char line[160];
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  if (n > 0)
+    serial_send(line, min((size_t)n, sizeof(line) - 1));
+}
+
+/* TP_IRQ falling edge: a press started */
+void IRAM_ATTR touch_irq_isr() {
+  BaseType_t woken = pdFALSE;
+  if (io_task_handle)
+    vTaskNotifyGiveFromISR(io_task_handle, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+/* io_task only: last known telemetry, merged from full/delta frames, and
+ * the changes not yet handed to render_task */
+static tp_telemetry stats;
+static uint16_t pending_changed = 0;
+static TpTracer tracer;
+static tp_trace pending_trace; /* newest stamp covered by pending_changed */
+static bool pending_traced = false;
 
 /* UI Elements */
+lv_obj_t *tabview;
 lv_obj_t *label_cpu;
 lv_obj_t *label_ram;
 lv_obj_t *label_temp;
 lv_obj_t *label_ip;
+lv_obj_t *label_uplink;
+lv_obj_t *label_hotspot;
 lv_obj_t *bar_cpu;
 lv_obj_t *bar_ram;
 
 /* =============================================
- * RAW SPI TOUCH (from firmware_v1)
+ * TOUCH (shared XPT2046 driver, io_task)
  * ============================================= */
-uint16_t touchReadChannel(uint8_t cmd) {
-  touchSPI.beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-  digitalWrite(TP_CS, LOW);
-  touchSPI.transfer(cmd);
-  uint8_t hi = touchSPI.transfer(0);
-  uint8_t lo = touchSPI.transfer(0);
-  digitalWrite(TP_CS, HIGH);
-  touchSPI.endTransaction();
-  return ((hi << 8) | lo) >> 3;
-}
-
-void touchPowerDown() {
-  touchSPI.beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-  digitalWrite(TP_CS, LOW);
-  touchSPI.transfer(0x80);
-  touchSPI.transfer(0);
-  touchSPI.transfer(0);
-  digitalWrite(TP_CS, HIGH);
-  touchSPI.endTransaction();
-}
-
 bool getTouch(int &x, int &y) {
-  if (digitalRead(TP_IRQ) != LOW)
+  if (!touch.touched())
     return false;
-  uint16_t z1 = touchReadChannel(0xB1);
-  uint16_t z2 = touchReadChannel(0xC1);
-  int z = z1 + 4095 - z2;
-  if (z > 400) {
-    uint16_t rawX = touchReadChannel(0xD1);
-    uint16_t rawY = touchReadChannel(0x91);
-    touchPowerDown();
-    x = map(rawY, 200, 3800, 0, 320);
-    y = map(rawX, 300, 3700, 0, 240);
-    x = constrain(x, 0, 319);
-    y = constrain(y, 0, 239);
-    return true;
-  }
-  touchPowerDown();
-  return false;
+  PerfTimer timer(PERF_TOUCH);
+  return touch.read(x, y);
 }
 
 /* =============================================
  * LVGL DISPLAY DRIVER
  * ============================================= */
+static uint32_t frames_flushed = 0; /* complete refreshes */
+static uint32_t frame_done_us = 0;  /* micros() at the end of the last one */
+
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area,
                    lv_color_t *color_p) {
+  PerfTimer timer(PERF_FLUSH);
+  static uint32_t frame_bytes = 0;
   uint32_t w = (area->x2 - area->x1 + 1);
   uint32_t h = (area->y2 - area->y1 + 1);
 
-  tft.startWrite();
-  tft.setAddrWindow(area->x1, area->y1, w, h);
-  tft.pushColors((uint16_t *)&color_p->full, w * h, true);
-  tft.endWrite();
+  /* pushImageDMA() first waits for the previous band's transfer, then
+   * queues this one and returns. TFT_eSPI has no DMA-complete callback, so
+   * the buffer is handed back right away: LVGL only draws into the other
+   * buffer next, and that one is free by the time this flush returned. */
+  tft.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
+
+  frame_bytes += w * h * sizeof(lv_color_t);
+  if (lv_disp_flush_is_last(disp)) {
+    perf_frame(frame_bytes);
+    frame_bytes = 0;
+    frames_flushed++;
+    frame_done_us = micros(); /* the last band's DMA is still running */
+  }
 
   lv_disp_flush_ready(disp);
 }
 
+/* =============================================
+ * DISPLAY POWER (render_task)
+ * =============================================
+ * With the backlight off the panel sleeps (SLPIN) and LVGL draws nothing:
+ * invalidation is off and the refresh timer paused, so telemetry keeps
+ * updating the widgets and history but no pixels are rendered or sent
+ * over SPI. Waking sends one SLPOUT and redraws the screen in a single
+ * refresh that shows everything that changed meanwhile. */
+#define PANEL_SLPOUT_MS 5 /* ST7789: from SLPOUT to the next command */
+
+static void display_sleep() {
+  lv_disp_t *disp = lv_disp_get_default();
+  lv_refr_now(disp); /* flush what is still queued */
+  lv_disp_enable_invalidation(disp, false);
+  lv_timer_pause(_lv_disp_get_refr_timer(disp));
+  digitalWrite(TFT_BL, LOW);
+  tft.dmaWait(); /* the last band must be out before the command */
+  tft.writecommand(TFT_SLPIN);
+  display_on = false;
+}
+
+static void display_wake() {
+  tft.writecommand(TFT_SLPOUT);
+  delay(PANEL_SLPOUT_MS);
+  lv_disp_t *disp = lv_disp_get_default();
+  lv_disp_enable_invalidation(disp, true);
+  /* What changed while asleep was not tracked: redraw it all, once */
+  lv_obj_invalidate(lv_scr_act());
+  lv_timer_t *refr = _lv_disp_get_refr_timer(disp);
+  lv_timer_resume(refr);
+  lv_timer_ready(refr);
+  digitalWrite(TFT_BL, HIGH);
+  display_on = true;
+}
+
 /* =============================================
  * LVGL TOUCH INPUT DRIVER
  * ============================================= */
-static int last_touch_x = 0, last_touch_y = 0;
+static touch_event touch_state = {false, 0, 0, 0};
+static bool wake_touch = false; /* press that woke the screen, until release */
+/* Sample time of the last touch event read; for a click (LVGL acts on
+ * release) that is the release. Sent with the command it triggers. */
+static uint32_t touch_us = 0;
 
+/* Replays the touch events sampled by io_task */
 void my_touchpad_read(lv_indev_drv_t *indev, lv_indev_data_t *data) {
-  int x, y;
-  if (getTouch(x, y)) {
-    /* Wake up screen if off */
-    if (!display_on) {
-      display_on = true;
-      digitalWrite(TFT_BL, HIGH);
+  touch_event ev;
+  while (touch_queue.pop(ev)) {
+    if (ev.pressed) {
       last_activity = millis();
-      data->state = LV_INDEV_STATE_REL; /* Ignore first touch (wake up only) */
-      data->point.x = last_touch_x;
-      data->point.y = last_touch_y;
-      return;
+      /* Wake up screen if off; that touch is not a tap */
+      if (!display_on) {
+        display_wake();
+        wake_touch = true;
+      }
+    } else {
+      wake_touch = false;
     }
-    last_activity = millis();
-    data->state = LV_INDEV_STATE_PR;
-    data->point.x = x;
-    data->point.y = y;
-    last_touch_x = x;
-    last_touch_y = y;
-  } else {
-    data->state = LV_INDEV_STATE_REL;
-    data->point.x = last_touch_x;
-    data->point.y = last_touch_y;
+    touch_state = ev;
+    touch_us = ev.us;
   }
+
+  data->state = touch_state.pressed && !wake_touch ? LV_INDEV_STATE_PR
+                                                   : LV_INDEV_STATE_REL;
+  data->point.x = touch_state.x;
+  data->point.y = touch_state.y;
 }
 
 /* =============================================
  * SEND COMMAND TO BRIDGE
  * ============================================= */
-void sendCommand(const char *action) {
-  JsonDocument doc;
-  doc["action"] = action;
-  String json;
-  serializeJson(doc, json);
-  Serial.println(json);
+void sendCommand(const tp_action &action) {
+  uint8_t cmd[TP_COMMAND_MAX]; /* fixed size, no heap */
+  size_t n = tp_encode_command(action, bridge_takes_frames, touch_us, cmd);
+  serial_send(cmd, n);
+}
+
+/* =============================================
+ * DIALOGS
+ * =============================================
+ * The confirmation box and the progress toast are created once by
+ * build_dialogs() and from then on only re-labelled, shown and hidden;
+ * a single timer, paused while idle, closes the toast. Taps allocate
+ * nothing from the LVGL heap, so its high-water mark and fragmentation
+ * (reported by send_perf) stay flat however often the buttons are used.
+ *
+ * After YES the toast shows "Sent!", then follows the bridge's job updates
+ * for that action. It closes JOB_RESULT_MS after the result arrives, or
+ * JOB_ACK_TIMEOUT_MS after sending if the bridge never reports (older
+ * bridges don't). Tapping it closes it early. */
+#define JOB_ACK_TIMEOUT_MS 1500
+#define JOB_RESULT_MS 2500
+
+static lv_obj_t *confirm_box; /* msgbox; its parent is the modal backdrop */
+static const tp_action *confirm_action = NULL;
+
+static lv_obj_t *toast;
+static lv_timer_t *toast_timer;
+static char toast_text[24];          /* shown as static label text */
+static const char *job_action = NULL; /* action the toast follows */
+
+static void toast_hide() {
+  lv_obj_add_flag(toast, LV_OBJ_FLAG_HIDDEN);
+  lv_timer_pause(toast_timer);
+  job_action = NULL;
+}
+
+/* Show toast_text; close after ms, or stay up if 0 */
+static void toast_show(uint32_t ms) {
+  lv_label_set_text_static(lv_msgbox_get_text(toast), toast_text);
+  lv_obj_clear_flag(toast, LV_OBJ_FLAG_HIDDEN);
+  if (ms) {
+    lv_timer_set_period(toast_timer, ms);
+    lv_timer_reset(toast_timer);
+    lv_timer_resume(toast_timer);
+  } else {
+    lv_timer_pause(toast_timer);
+  }
+}
+
+static void show_job(const tp_job &job) {
+  if (!job_action || strcmp(job.action, job_action) != 0)
+    return;
+  tp_job_text(job, toast_text, sizeof(toast_text));
+  /* Stay up while it runs, then show the result for a while */
+  toast_show(tp_job_finished(job) ? JOB_RESULT_MS : 0);
+}
+
+/* Send the command and follow its job in the toast */
+static void run_action(const tp_action &action) {
+  sendCommand(action);
+  job_action = action.name;
+  snprintf(toast_text, sizeof(toast_text), "Sent!");
+  toast_show(JOB_ACK_TIMEOUT_MS);
+}
+
+static void confirm_open(const tp_action &action) {
+  confirm_action = &action;
+  lv_label_set_text_static(lv_msgbox_get_text(confirm_box), action.label);
+  lv_obj_clear_flag(lv_obj_get_parent(confirm_box), LV_OBJ_FLAG_HIDDEN);
+}
+
+static void confirm_event_cb(lv_event_t *e) {
+  uint16_t idx = lv_msgbox_get_active_btn(confirm_box);
+  lv_obj_add_flag(lv_obj_get_parent(confirm_box), LV_OBJ_FLAG_HIDDEN);
+  if (idx == 0) /* YES */
+    run_action(*confirm_action);
+}
+
+static void build_dialogs() {
+  /* Modal: a NULL parent puts it on a backdrop over the top layer */
+  static const char *btns[] = {"YES", "NO", ""};
+  confirm_box = lv_msgbox_create(NULL, "Confirm?", "-", btns, false);
+  lv_obj_set_width(confirm_box, 260);
+  lv_obj_center(confirm_box);
+  lv_obj_add_event_cb(confirm_box, confirm_event_cb, LV_EVENT_VALUE_CHANGED,
+                      NULL);
+  lv_obj_add_flag(lv_obj_get_parent(confirm_box), LV_OBJ_FLAG_HIDDEN);
+
+  toast = lv_msgbox_create(lv_layer_top(), NULL, "-", NULL, false);
+  lv_obj_center(toast);
+  lv_obj_add_flag(toast, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_event_cb(toast, [](lv_event_t *) { toast_hide(); },
+                      LV_EVENT_CLICKED, NULL);
+  toast_timer = lv_timer_create([](lv_timer_t *) { toast_hide(); },
+                                JOB_ACK_TIMEOUT_MS, NULL);
+  toast_hide();
 }
 
 /* =============================================
@@ -147,67 +467,25 @@ static void btn_event_cb(lv_event_t *e) {
   if (code != LV_EVENT_CLICKED)
     return;
 
-  const char *action = (const char *)lv_event_get_user_data(e);
-  lv_obj_t *btn = lv_event_get_target(e);
-
-  /* Get button label text for the dialog */
-  lv_obj_t *label = lv_obj_get_child(btn, 0);
-  const char *btn_text = lv_label_get_text(label);
-
-  /* Create msgbox for confirmation */
-  static const char *btns[] = {"YES", "NO", ""};
-  char msg[64];
-  snprintf(msg, sizeof(msg), "%s", btn_text);
-
-  lv_obj_t *mbox = lv_msgbox_create(NULL, "Confirm?", msg, btns, false);
-  lv_obj_center(mbox);
-  lv_obj_set_width(mbox, 260);
-
-  /* Store action string in mbox user data */
-  lv_obj_set_user_data(mbox, (void *)action);
-
-  /* Add event handler for msgbox buttons */
-  lv_obj_add_event_cb(
-      mbox,
-      [](lv_event_t *ev) {
-        lv_obj_t *msgbox = lv_event_get_current_target(ev);
-        uint16_t idx = lv_msgbox_get_active_btn(msgbox);
-        if (idx == 0) { /* YES */
-          const char *act = (const char *)lv_obj_get_user_data(msgbox);
-          sendCommand(act);
-
-          /* Show "Sent!" notification */
-          lv_obj_t *notif = lv_msgbox_create(NULL, NULL, "Sent!", NULL, true);
-          lv_obj_center(notif);
-
-          /* Auto-close after 1.5s */
-          lv_timer_create(
-              [](lv_timer_t *t) {
-                lv_obj_t *n = (lv_obj_t *)t->user_data;
-                if (n)
-                  lv_msgbox_close(n);
-                lv_timer_del(t);
-              },
-              1500, notif);
-        }
-        lv_msgbox_close(msgbox);
-      },
-      LV_EVENT_VALUE_CHANGED, NULL);
+  const tp_action &action = *(const tp_action *)lv_event_get_user_data(e);
+  if (action.confirm)
+    confirm_open(action);
+  else
+    run_action(action);
 }
 
 /* Helper: create a control button */
-void create_ctrl_btn(lv_obj_t *parent, const char *label, const char *action,
-                     lv_color_t color) {
+void create_ctrl_btn(lv_obj_t *parent, const tp_action &action) {
   lv_obj_t *btn = lv_btn_create(parent);
   lv_obj_set_size(btn, 140, 36);
-  lv_obj_set_style_bg_color(btn, color, 0);
+  lv_obj_set_style_bg_color(btn, lv_color_hex(action.rgb), 0);
   lv_obj_set_style_radius(btn, 6, 0);
 
   lv_obj_t *lbl = lv_label_create(btn);
-  lv_label_set_text(lbl, label);
+  lv_label_set_text_static(lbl, action.label);
   lv_obj_center(lbl);
 
-  lv_obj_add_event_cb(btn, btn_event_cb, LV_EVENT_CLICKED, (void *)action);
+  lv_obj_add_event_cb(btn, btn_event_cb, LV_EVENT_CLICKED, (void *)&action);
 }
 
 /* Apply the default theme at runtime (dark=true => dark theme) */
@@ -219,11 +497,334 @@ void apply_theme(bool dark) {
                                         lv_palette_main(LV_PALETTE_RED),
                                         dark, LV_FONT_DEFAULT);
   lv_disp_set_theme(disp, th);
-  Serial.printf("Applied theme: %s\n", dark ? "dark" : "light");
+  serial_printf("Applied theme: %s\n", dark ? "dark" : "light");
+}
+
+/* =============================================
+ * METRIC HISTORY (render_task)
+ * =============================================
+ * Every HISTORY_PERIOD_MS the latest CPU, RAM and temperature readings are
+ * appended to a ring of HISTORY_POINTS samples per metric, quantized to
+ * 8 bits in half-unit steps (0..127.5 % or C). With the defaults that is
+ * 15 minutes in 3 x 90 = 270 bytes of static RAM.
+ *
+ * The chart only exists while the History tab is open: it is built from
+ * the ring then and deleted when the tab is left, so its lv_coord_t point
+ * arrays (3 x 90 x 2 = 540 bytes of LVGL heap, plus the widget) are not
+ * held the rest of the time. While open, each new sample is appended
+ * with lv_chart_set_next_value rather than rewriting the series.
+ *
+ * A period without telemetry (no bridge) is stored as a gap rather than
+ * a repeat of the last reading, and so are periods the timer missed while
+ * the chip light-slept; the chart leaves them blank. */
+#define HISTORY_PERIOD_MS 10000
+#define HISTORY_POINTS 90
+#define HISTORY_GAP 0xFF /* no telemetry in that period */
+
+enum history_metric : uint8_t { HIST_CPU, HIST_RAM, HIST_TEMP, HIST_COUNT };
+
+static const char *const HISTORY_NAMES[HIST_COUNT] = {"CPU", "RAM", "Temp"};
+static const uint32_t HISTORY_COLORS[HIST_COUNT] = {0x2196F3, 0x4CAF50,
+                                                    0xFF9800};
+
+static uint8_t history[HIST_COUNT][HISTORY_POINTS];
+static uint16_t history_head = 0;  /* next slot to write */
+static uint16_t history_count = 0; /* valid samples, up to HISTORY_POINTS */
+static uint8_t history_now[HIST_COUNT]; /* latest readings, quantized */
+static bool history_live = false;       /* telemetry has arrived */
+static bool history_fresh = false;      /* ...since the last sample */
+static uint32_t history_last_ms;        /* millis() of the last sample */
+
+static lv_obj_t *history_tab;
+static lv_obj_t *history_chart = NULL;
+static lv_chart_series_t *history_series[HIST_COUNT];
+
+static uint8_t history_quantize(float v) {
+  return (uint8_t)constrain((int)lroundf(v * 2), 0, HISTORY_GAP - 1);
+}
+
+static lv_coord_t history_point(uint8_t v) {
+  return v == HISTORY_GAP ? LV_CHART_POINT_NONE : v;
+}
+
+/* Latest telemetry, sampled by the next history tick */
+static void history_note(const tp_telemetry &t) {
+  history_now[HIST_CPU] = history_quantize(t.cpu);
+  history_now[HIST_RAM] = history_quantize(t.ram_percent);
+  history_now[HIST_TEMP] = history_quantize(t.temp);
+  history_live = true;
+  history_fresh = true;
+}
+
+/* Append one sample per metric, gaps if fresh is false */
+static void history_push(bool fresh) {
+  for (int m = 0; m < HIST_COUNT; m++) {
+    uint8_t v = fresh ? history_now[m] : HISTORY_GAP;
+    history[m][history_head] = v;
+    if (history_chart)
+      lv_chart_set_next_value(history_chart, history_series[m],
+                              history_point(v));
+  }
+  history_head = (history_head + 1) % HISTORY_POINTS;
+  if (history_count < HISTORY_POINTS)
+    history_count++;
+}
+
+static void history_tick(lv_timer_t *) {
+  if (!history_live)
+    return;
+  /* Periods since the last sample: more than one after a light sleep */
+  uint32_t now = millis();
+  uint32_t periods = 1;
+  if (history_count)
+    periods = (now - history_last_ms + HISTORY_PERIOD_MS / 2) /
+              HISTORY_PERIOD_MS;
+  if (!periods)
+    return;
+  history_last_ms = now;
+  for (uint32_t i = 1; i < periods && i <= HISTORY_POINTS; i++)
+    history_push(false);
+  history_push(history_fresh);
+  history_fresh = false;
+}
+
+static void history_chart_open() {
+  if (history_chart)
+    return;
+  history_chart = lv_chart_create(history_tab);
+  lv_obj_set_size(history_chart, lv_pct(100), 140);
+  lv_obj_align(history_chart, LV_ALIGN_BOTTOM_MID, 0, 0);
+  lv_obj_clear_flag(history_chart, LV_OBJ_FLAG_CLICKABLE); /* let swipes through */
+  lv_chart_set_type(history_chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_update_mode(history_chart, LV_CHART_UPDATE_MODE_SHIFT);
+  lv_chart_set_point_count(history_chart, HISTORY_POINTS);
+  lv_chart_set_range(history_chart, LV_CHART_AXIS_PRIMARY_Y, 0, 200); /* 0-100 */
+  lv_chart_set_div_line_count(history_chart, 5, 0);
+  lv_obj_set_style_size(history_chart, 0, LV_PART_INDICATOR); /* no dots */
+
+  /* Oldest sample first; slots without a sample yet stay empty */
+  uint16_t empty = HISTORY_POINTS - history_count;
+  for (int m = 0; m < HIST_COUNT; m++) {
+    history_series[m] = lv_chart_add_series(
+        history_chart, lv_color_hex(HISTORY_COLORS[m]), LV_CHART_AXIS_PRIMARY_Y);
+    lv_coord_t *y = lv_chart_get_y_array(history_chart, history_series[m]);
+    for (uint16_t i = 0; i < history_count; i++)
+      y[empty + i] = history_point(
+          history[m][(history_head + HISTORY_POINTS - history_count + i) %
+                     HISTORY_POINTS]);
+  }
+  lv_chart_refresh(history_chart);
+}
+
+static void history_chart_close() {
+  if (!history_chart)
+    return;
+  lv_obj_del(history_chart);
+  history_chart = NULL;
+}
+
+static void build_history_tab(lv_obj_t *tab) {
+  history_tab = tab;
+
+  /* Legend */
+  lv_obj_t *prev = NULL;
+  for (int m = 0; m < HIST_COUNT; m++) {
+    lv_obj_t *l = lv_label_create(tab);
+    lv_label_set_text_static(l, HISTORY_NAMES[m]);
+    lv_obj_set_style_text_color(l, lv_color_hex(HISTORY_COLORS[m]), 0);
+    if (prev)
+      lv_obj_align_to(l, prev, LV_ALIGN_OUT_RIGHT_MID, 16, 0);
+    else
+      lv_obj_align(l, LV_ALIGN_TOP_LEFT, 0, 0);
+    prev = l;
+  }
+
+  lv_obj_t *span = lv_label_create(tab);
+  lv_label_set_text_fmt(span, "last %d min",
+                        HISTORY_POINTS * HISTORY_PERIOD_MS / 60000);
+  lv_obj_align(span, LV_ALIGN_TOP_RIGHT, 0, 0);
+
+  lv_timer_create(history_tick, HISTORY_PERIOD_MS, NULL);
+}
+
+/* =============================================
+ * WIDGET BINDINGS (render_task)
+ * =============================================
+ * Each status widget is bound to the telemetry fields it shows. On an
+ * update only the bindings whose fields changed are formatted, with
+ * integer code into a scratch buffer, and LVGL is only called when the
+ * result differs from what the widget shows: a CPU reading that moves
+ * from 12.4 to 12.6 % costs a compare, not a redraw. Labels show their
+ * binding's buffer as static text, so updates never touch the LVGL heap. */
+#define BIND_TEXT_MAX 72 /* longest: a traffic row with drops */
+
+typedef void (*bind_format_fn)(const tp_telemetry &t, char *buf, size_t len);
+
+struct label_binding {
+  uint16_t fields; /* tp_field bits it depends on */
+  lv_obj_t *const *label;
+  bind_format_fn format;
+  char shown[BIND_TEXT_MAX]; /* the label's static text */
+};
+
+struct bar_binding {
+  uint16_t fields;
+  lv_obj_t *const *bar;
+  int (*value)(const tp_telemetry &t);
+  int shown;
+};
+
+/* Writers for the formatters: append at p, never past end (which is kept
+ * free for the terminator), return the new end of the text */
+static char *put_str(char *p, char *end, const char *s) {
+  while (*s && p < end)
+    *p++ = *s++;
+  return p;
+}
+
+static char *put_uint(char *p, char *end, uint32_t v) {
+  char digits[10];
+  int n = 0;
+  do {
+    digits[n++] = '0' + v % 10;
+    v /= 10;
+  } while (v);
+  while (n && p < end)
+    *p++ = digits[--n];
+  return p;
+}
+
+/* Fixed point with one decimal: 517 -> "51.7", -5 -> "-0.5" */
+static char *put_tenths(char *p, char *end, int32_t v) {
+  if (v < 0 && p < end) {
+    *p++ = '-';
+    v = -v;
+  }
+  p = put_uint(p, end, v / 10);
+  p = put_str(p, end, ".");
+  return put_uint(p, end, v % 10);
+}
+
+static int32_t tenths(float v) { return (int32_t)lroundf(v * 10); }
+
+static void format_percent(char *buf, size_t len, int v) {
+  char *p = put_uint(buf, buf + len - 1, v < 0 ? 0 : v);
+  *put_str(p, buf + len - 1, "%") = '\0';
+}
+
+static void format_cpu(const tp_telemetry &t, char *buf, size_t len) {
+  format_percent(buf, len, (int)t.cpu);
+}
+
+static void format_ram(const tp_telemetry &t, char *buf, size_t len) {
+  format_percent(buf, len, (int)t.ram_percent);
+}
+
+static void format_temp(const tp_telemetry &t, char *buf, size_t len) {
+  char *end = buf + len - 1;
+  *put_str(put_tenths(buf, end, tenths(t.temp)), end, " C") = '\0';
+}
+
+/* Network IP: wlan0's, or else the first other interface that has one,
+ * named ("eth0: 10.0.0.5"), as the original uap0 fallback did */
+static void format_ip(const tp_telemetry &t, char *buf, size_t len) {
+  char *end = buf + len - 1;
+  int iface = 0;
+  while (iface < TP_IF_COUNT && !tp_ip_valid(t.ip[iface]))
+    iface++;
+  if (iface == TP_IF_COUNT) {
+    *put_str(buf, end, "IP: N/A") = '\0';
+    return;
+  }
+  char *p = iface == TP_IF_WLAN0
+                ? put_str(buf, end, "IP: ")
+                : put_str(put_str(buf, end, tp_if_names[iface]), end, ": ");
+  const uint8_t *a = t.ip[iface];
+  for (int i = 0; i < 4; i++) {
+    if (i)
+      p = put_str(p, end, ".");
+    p = put_uint(p, end, a[i]);
+  }
+  *p = '\0';
+}
+
+/* "WAN  <down> 1.2 MB/s  <up> 80 KB/s", plus drops/s in orange if any */
+static void format_traffic(const char *name, const tp_traffic &t, char *buf,
+                           size_t len) {
+  char rate[12];
+  char *end = buf + len - 1;
+  char *p = put_str(buf, end, name);
+  p = put_str(p, end, "  " LV_SYMBOL_DOWNLOAD " ");
+  p = put_str(p, end, tp_format_rate(t.rx, rate, sizeof(rate)));
+  p = put_str(p, end, "  " LV_SYMBOL_UPLOAD " ");
+  p = put_str(p, end, tp_format_rate(t.tx, rate, sizeof(rate)));
+  int32_t drops = tenths(t.drops);
+  if (drops > 0) {
+    p = put_str(p, end, "  #ff9800 " LV_SYMBOL_WARNING " ");
+    p = put_str(put_tenths(p, end, drops), end, "/s#");
+  }
+  *p = '\0';
+}
+
+static void format_uplink(const tp_telemetry &t, char *buf, size_t len) {
+  format_traffic("WAN", t.uplink, buf, len);
+}
+
+static void format_hotspot(const tp_telemetry &t, char *buf, size_t len) {
+  format_traffic("AP", t.hotspot, buf, len);
+}
+
+/* shown holds the text until the first update */
+static label_binding label_bindings[] = {
+    {TP_F_CPU, &label_cpu, format_cpu, "0%"},
+    {TP_F_RAM_PCT, &label_ram, format_ram, "0%"},
+    {TP_F_TEMP, &label_temp, format_temp, "0 C"},
+    {TP_F_NET, &label_ip, format_ip, "IP: Waiting..."},
+    {TP_F_UPLINK, &label_uplink, format_uplink, ""},
+    {TP_F_HOTSPOT, &label_hotspot, format_hotspot, ""},
+};
+
+static bar_binding bar_bindings[] = {
+    {TP_F_CPU, &bar_cpu, [](const tp_telemetry &t) { return (int)t.cpu; }, 0},
+    {TP_F_RAM_PCT, &bar_ram,
+     [](const tp_telemetry &t) { return (int)t.ram_percent; }, 0},
+};
+
+/* Point the bound labels at their static text (after build_ui created
+ * them) */
+static void bind_widgets() {
+  for (label_binding &b : label_bindings)
+    lv_label_set_text_static(*b.label, b.shown);
+  for (bar_binding &b : bar_bindings)
+    lv_bar_set_value(*b.bar, b.shown, LV_ANIM_OFF);
+}
+
+/* Refresh only the widgets whose visible value changed */
+void show_stats(const tp_telemetry &t, uint16_t changed) {
+  for (bar_binding &b : bar_bindings) {
+    if (!(changed & b.fields))
+      continue;
+    int v = b.value(t);
+    if (v != b.shown) {
+      b.shown = v;
+      lv_bar_set_value(*b.bar, v, LV_ANIM_OFF);
+    }
+  }
+
+  char text[BIND_TEXT_MAX];
+  for (label_binding &b : label_bindings) {
+    if (!(changed & b.fields))
+      continue;
+    b.format(t, text, sizeof(text));
+    if (strcmp(text, b.shown) != 0) {
+      memcpy(b.shown, text, sizeof(text));
+      lv_label_set_text_static(*b.label, b.shown); /* re-reads, invalidates */
+    }
+  }
 }
 
 void build_ui() {
-  lv_obj_t *tabview = lv_tabview_create(lv_scr_act(), LV_DIR_TOP, 50);
+  tabview = lv_tabview_create(lv_scr_act(), LV_DIR_TOP, 50);
 
   /* Tab 1: Dashboard */
   lv_obj_t *tab1 = lv_tabview_add_tab(tabview, "Status");
@@ -231,42 +832,59 @@ void build_ui() {
   /* CPU Label & Bar */
   lv_obj_t *l1 = lv_label_create(tab1);
   lv_label_set_text(l1, "CPU Usage");
-  lv_obj_align(l1, LV_ALIGN_TOP_LEFT, 10, 10);
+  lv_obj_align(l1, LV_ALIGN_TOP_LEFT, 10, 0);
 
   bar_cpu = lv_bar_create(tab1);
   lv_obj_set_size(bar_cpu, 200, 20);
-  lv_obj_align(bar_cpu, LV_ALIGN_TOP_LEFT, 10, 35);
+  lv_obj_align(bar_cpu, LV_ALIGN_TOP_LEFT, 10, 22);
   lv_bar_set_range(bar_cpu, 0, 100);
 
   label_cpu = lv_label_create(tab1);
-  lv_label_set_text(label_cpu, "0%");
   lv_obj_align_to(label_cpu, bar_cpu, LV_ALIGN_OUT_RIGHT_MID, 10, 0);
 
   /* RAM Label & Bar */
   lv_obj_t *l2 = lv_label_create(tab1);
   lv_label_set_text(l2, "RAM Usage");
-  lv_obj_align(l2, LV_ALIGN_TOP_LEFT, 10, 70);
+  lv_obj_align(l2, LV_ALIGN_TOP_LEFT, 10, 50);
 
   bar_ram = lv_bar_create(tab1);
   lv_obj_set_size(bar_ram, 200, 20);
-  lv_obj_align(bar_ram, LV_ALIGN_TOP_LEFT, 10, 95);
+  lv_obj_align(bar_ram, LV_ALIGN_TOP_LEFT, 10, 72);
   lv_bar_set_range(bar_ram, 0, 100);
 
   label_ram = lv_label_create(tab1);
-  lv_label_set_text(label_ram, "0%");
   lv_obj_align_to(label_ram, bar_ram, LV_ALIGN_OUT_RIGHT_MID, 10, 0);
 
+  /* Uplink / hotspot throughput */
+  label_uplink = lv_label_create(tab1);
+  lv_label_set_recolor(label_uplink, true);
+  lv_obj_align(label_uplink, LV_ALIGN_TOP_LEFT, 10, 100);
+
+  label_hotspot = lv_label_create(tab1);
+  lv_label_set_recolor(label_hotspot, true);
+  lv_obj_align(label_hotspot, LV_ALIGN_TOP_LEFT, 10, 120);
+
   /* IP Address */
   label_ip = lv_label_create(tab1);
-  lv_label_set_text(label_ip, "IP: Waiting...");
   lv_obj_align(label_ip, LV_ALIGN_BOTTOM_LEFT, 10, -10);
 
   /* Temp */
   label_temp = lv_label_create(tab1);
-  lv_label_set_text(label_temp, "0 C");
   lv_obj_align(label_temp, LV_ALIGN_BOTTOM_RIGHT, -10, -10);
 
-  /* Tab 2: Controls */
+  /* Tab 2: History, chart built only while it is shown */
+  build_history_tab(lv_tabview_add_tab(tabview, "History"));
+  lv_obj_add_event_cb(tabview,
+                      [](lv_event_t *e) {
+                        lv_obj_t *tv = lv_event_get_target(e);
+                        if (lv_tabview_get_tab_act(tv) == 1)
+                          history_chart_open();
+                        else
+                          history_chart_close();
+                      },
+                      LV_EVENT_VALUE_CHANGED, NULL);
+
+  /* Tab 3: Controls */
   lv_obj_t *tab2 = lv_tabview_add_tab(tabview, "Controls");
 
   /* Flex wrap layout for buttons */
@@ -276,16 +894,11 @@ void build_ui() {
   lv_obj_set_style_pad_column(tab2, 8, 0);
   lv_obj_set_style_pad_row(tab2, 6, 0);
 
-  /* Create all 7 buttons matching firmware_v1 */
-  create_ctrl_btn(tab2, "Reset Net", "reset_network", lv_color_hex(0xFC6000));
-  create_ctrl_btn(tab2, "FW Strict", "fw_strict", lv_color_hex(0xD00000));
-  create_ctrl_btn(tab2, "FW Maint", "fw_maint", lv_color_hex(0xC8A000));
-  create_ctrl_btn(tab2, "Start SMB", "start_smb", lv_color_hex(0x00804A));
-  create_ctrl_btn(tab2, "Stop SMB", "stop_smb", lv_color_hex(0xD00000));
-  create_ctrl_btn(tab2, "Reboot", "reboot", lv_color_hex(0xFC6000));
-  create_ctrl_btn(tab2, "Shutdown", "shutdown", lv_color_hex(0x800020));
+  /* One button per action (LCD/actions/actions.json), as on firmware_v1 */
+  for (const tp_action &action : tp_actions)
+    create_ctrl_btn(tab2, action);
 
-  /* Tab 3: Settings (gear icon)
+  /* Tab 4: Settings (gear icon)
    * - Add a toggle to switch between dark and light theme at runtime
    */
   lv_obj_t *tab3 = lv_tabview_add_tab(tabview, LV_SYMBOL_SETTINGS " Settings");
@@ -313,64 +926,358 @@ void build_ui() {
                       },
                       LV_EVENT_VALUE_CHANGED, NULL);
 
+  bind_widgets();
+  build_dialogs();
+
   /* Apply initial theme according to LV_THEME_DEFAULT_DARK */
   apply_theme(LV_THEME_DEFAULT_DARK);
 }
 
-void update_stats(String json) {
-  JsonDocument doc;
+/* Answer the bridge's hello so it switches to binary telemetry */
+void send_hello() {
+  serial_printf("{\"hello\":\"travel-lcd\",\"fw\":\"v2\",\"proto\":%d,"
+                "\"delta\":1,\"trace\":1,\"baud\":" TP_BAUD_RATES_JSON
+                "}\n",
+                TP_VERSION);
+}
+
+/* =============================================
+ * LINK SPEED (io_task)
+ * ============================================= */
+/* Caller holds tx_lock: render_task's acks and reports wait for the new
+ * rate instead of straddling the switch */
+static void set_baud(uint32_t rate) {
+  Serial.flush();
+  Serial.updateBaudRate(rate);
+  link_baud = rate;
+}
+
+/* Acknowledge at the old rate, then switch, with nothing sent between */
+static void handle_baud_offer(uint32_t rate) {
+  bool ok = serial_link.offer(rate, millis(), framer.dropped());
+  char answer[24];
+  int n = snprintf(answer, sizeof(answer), "{\"baud\":%lu}\n",
+                   ok ? (unsigned long)rate : 0UL);
+  tx_hold();
+  Serial.write((const uint8_t *)answer, n);
+  if (ok)
+    set_baud(rate);
+  tx_release();
+}
+
+static void echo_probe(const TpFramer &f) {
+  size_t len = f.payloadLength();
+  if (len > TP_PROBE_MAX)
+    return;
+  uint8_t out[TP_FRAME_OUT(TP_PROBE_MAX)];
+  serial_send(out, tp_encode_frame(TP_MSG_PROBE, f.payload(), len, out));
+  serial_link.probe();
+}
+
+/* Trial ran out or too many bad frames: back to the default rate */
+static void check_link() {
+  uint32_t rate = serial_link.poll(millis(), framer.dropped());
+  if (rate) {
+    tx_hold();
+    set_baud(rate);
+    tx_release();
+    link_fallbacks = serial_link.fallbacks();
+    send_hello();
+  }
+  link_errors = framer.dropped() - serial_link.wakeDrops();
+}
+
+/* =============================================
+ * LATENCY TRACE (see TravelProto.h)
+ * =============================================
+ * io_task pairs each stamp with its telemetry and hands the trace over
+ * with the update; render_task acknowledges it once the refresh showing
+ * the update has been flushed. Updates that change nothing on screen,
+ * including every update while the display is off, are acknowledged right
+ * away. */
+#define TRACE_SLOTS 4 /* applied updates waiting for the same refresh */
+
+static void send_ack(const tp_trace &t, uint32_t done, tp_ack_status status) {
+  uint8_t out[TP_ACK_FRAME_SIZE];
+  serial_send(out, tp_encode_ack(t, done, status, out));
+}
+
+/* io_task: telemetry decoded, changing the fields in changed */
+static void trace_received(uint16_t changed) {
+  tp_trace t;
+  if (!tracer.take(micros(), t))
+    return;
+  if (!changed) {
+    send_ack(t, t.rx, TP_ACK_UNCHANGED);
+    return;
+  }
+  /* Not handed over yet: render_task will only see the merged update */
+  if (pending_traced)
+    send_ack(pending_trace, pending_trace.rx, TP_ACK_SUPERSEDED);
+  pending_trace = t;
+  pending_traced = true;
+}
+
+/* render_task only */
+static tp_trace drawing[TRACE_SLOTS];
+static uint8_t drawing_count = 0;
+static uint32_t drawing_frame; /* frames_flushed when they were applied */
+
+/* The update carrying t is in the widgets */
+static void trace_applied(const tp_trace &t) {
+  /* Nothing invalidated: none of its fields is on screen, or it is off */
+  if (!lv_disp_get_default()->inv_p) {
+    send_ack(t, t.rx, TP_ACK_UNCHANGED);
+    return;
+  }
+  if (drawing_count == TRACE_SLOTS) {
+    send_ack(t, t.rx, TP_ACK_SUPERSEDED);
+    return;
+  }
+  drawing[drawing_count++] = t;
+  drawing_frame = frames_flushed;
+}
+
+/* After lv_timer_handler(): acknowledge what the last refresh drew */
+static void trace_flushed() {
+  if (!drawing_count || frames_flushed == drawing_frame)
+    return;
+  for (uint8_t i = 0; i < drawing_count; i++)
+    send_ack(drawing[i], frame_done_us, TP_ACK_DRAWN);
+  drawing_count = 0;
+}
+
+void update_stats(const char *json) {
+  PerfTimer timer(PERF_PARSE);
+  json_arena.reset();
+  JsonDocument doc(&json_arena);
   DeserializationError error = deserializeJson(doc, json);
 
   if (error) {
-    Serial.print("deserializeJson() failed: ");
-    Serial.println(error.c_str());
+    serial_printf("deserializeJson() failed: %s\n", error.c_str());
     return;
   }
 
-  float cpu = doc["cpu"];
-  int ram_pct = doc["ram"]["percent"];
-  float temp = doc["temp"];
+  if (!doc["hello"].isNull()) {
+    bridge_takes_frames = (doc["cmd"] | 0) == 1;
+    send_hello();
+    return;
+  }
 
-  /* Update UI */
-  lv_bar_set_value(bar_cpu, (int)cpu, LV_ANIM_OFF);
-  lv_label_set_text_fmt(label_cpu, "%d%%", (int)cpu);
+  if (doc["baud"].is<uint32_t>()) {
+    handle_baud_offer(doc["baud"].as<uint32_t>());
+    return;
+  }
 
-  lv_bar_set_value(bar_ram, ram_pct, LV_ANIM_OFF);
-  lv_label_set_text_fmt(label_ram, "%d%%", ram_pct);
+  /* Dropped if render_task is 8 updates behind; the next one catches up */
+  tp_job job;
+  if (tp_parse_job(doc, job)) {
+    if (job_queue.push(job))
+      xTaskNotifyGive(render_task_handle);
+    return;
+  }
 
-  lv_label_set_text_fmt(label_temp, "%.1f C", temp);
+  uint16_t changed;
+  if (tp_merge_json(doc, stats, changed)) {
+    pending_changed |= changed;
+    trace_received(changed);
+  }
+}
 
-  /* Network IP (Just grabbing wlan0 for demo) */
-  const char *ip = doc["net"]["wlan0"];
-  if (ip) {
-    lv_label_set_text_fmt(label_ip, "IP: %s", ip);
-  } else {
-    const char *ip_ap = doc["net"]["uap0"]; // Raspberry AP often uap0
-    if (ip_ap)
-      lv_label_set_text_fmt(label_ip, "AP: %s", ip_ap);
+void update_stats_binary(const TpFramer &f) {
+  PerfTimer timer(PERF_PARSE);
+  if (f.type() == TP_MSG_PROBE) {
+    echo_probe(f);
+    return;
+  }
+  if (f.type() == TP_MSG_STAMP) {
+    tracer.stamp(f.payload(), f.payloadLength());
+    return;
+  }
+  uint16_t changed;
+  if (tp_decode_telemetry(f.type(), f.payload(), f.payloadLength(), stats,
+                          changed)) {
+    pending_changed |= changed;
+    trace_received(changed);
   }
 }
 
-void setup() {
-  Serial.begin(115200);
-  delay(500);
+/* Periodic {"perf":...} line, with LVGL heap usage (render_task) */
+void send_perf() {
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  char extra[112];
+  snprintf(extra, sizeof(extra), "\"lv\":[%u,%u,%lu,%lu],\"link\":[%lu,%lu,%u]",
+           mon.used_pct, mon.frag_pct, (unsigned long)mon.free_biggest_size,
+           (unsigned long)mon.max_used, (unsigned long)link_baud.load(),
+           (unsigned long)link_errors.load(), link_fallbacks.load());
+
+  char line[288];
+  size_t n = perf_format_report(line, sizeof(line), millis(), extra);
+  serial_send(line, n);
+}
+
+/* =============================================
+ * TASK BODIES
+ * ============================================= */
+void io_task(void *) {
+  touch_event sent = {false, 0, 0};
+  for (;;) {
+    bool handed_over = false;
+
+    /* Before the bytes that woke the UART reach the framer */
+    if (uart_woke.exchange(false))
+      serial_link.woke(millis(), framer.dropped());
+
+    uint8_t c;
+    if (!rx_queue.empty())
+      last_rx_ms = millis();
+    while (rx_queue.pop(c)) {
+      switch (framer.push(c)) {
+      case TP_FRAME_JSON:
+        update_stats(framer.line());
+        break;
+      case TP_FRAME_BINARY:
+        update_stats_binary(framer);
+        break;
+      default:
+        break;
+      }
+    }
+    check_link();
+
+    /* If render_task is behind, keep accumulating and retry next pass */
+    if (pending_changed) {
+      telemetry_msg msg = {stats, pending_changed, pending_traced,
+                           pending_trace};
+      if (telemetry_queue.push(msg)) {
+        pending_changed = 0;
+        pending_traced = false;
+        handed_over = true;
+      }
+    }
+
+    /* Only state changes and moves are queued */
+    int x, y;
+    touch_event ev = {getTouch(x, y), 0, 0, (uint32_t)micros()};
+    if (ev.pressed) {
+      ev.x = x;
+      ev.y = y;
+    } else {
+      ev.x = sent.x;
+      ev.y = sent.y;
+    }
+    bool touch_pending =
+        ev.pressed != sent.pressed || ev.x != sent.x || ev.y != sent.y;
+    if (touch_pending && touch_queue.push(ev)) {
+      sent = ev;
+      touch_pending = false;
+      handed_over = true;
+    }
+
+    if (handed_over)
+      xTaskNotifyGive(render_task_handle);
+
+    /* Keep sampling while pressed, while a hand-over is still queued up
+     * behind a full queue or while a baud trial runs out; otherwise wait
+     * for the next RX / PENIRQ */
+    bool busy = sent.pressed || touch_pending || pending_changed ||
+                serial_link.trial();
+    io_idle = !busy;
+    ulTaskNotifyTake(pdTRUE,
+                     busy ? pdMS_TO_TICKS(IO_PERIOD_MS) : portMAX_DELAY);
+    io_idle = false;
+  }
+}
+
+/* Screen off, nothing queued, io_task waiting and no bridge talking:
+ * sleep the whole chip until PENIRQ goes low or the UART sees traffic.
+ * The bytes that wake the UART are lost, so the first frame after a
+ * wakeup is dropped (not counted as a link error, see TpLink::woke).
+ * That is why a connected bridge keeps the chip awake: its telemetry
+ * comes every 2 s and would be lost frame after frame. Only a bridge
+ * coming back loses a frame, typically its hello, which it repeats. */
+void light_sleep() {
+  Serial.flush(); /* let pending TX drain first */
+  gpio_wakeup_enable((gpio_num_t)TP_IRQ, GPIO_INTR_LOW_LEVEL);
+  esp_light_sleep_start();
+  /* The wakeup setting replaced the pin's interrupt type */
+  gpio_wakeup_disable((gpio_num_t)TP_IRQ);
+  gpio_set_intr_type((gpio_num_t)TP_IRQ, GPIO_INTR_NEGEDGE);
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UART)
+    uart_woke = true; /* io_task tells serial_link (TpLink::woke) */
+
+  /* Whatever woke us, let io_task look before deciding to sleep again */
+  io_idle = false;
+  xTaskNotifyGive(io_task_handle);
+}
+
+void render_task(void *) {
+  tft.startWrite(); /* Keep the bus (and CS) owned by the DMA flush path */
+  for (;;) {
+    telemetry_msg msg;
+    while (telemetry_queue.pop(msg)) {
+      show_stats(msg.stats, msg.changed);
+      history_note(msg.stats);
+      if (msg.traced)
+        trace_applied(msg.trace);
+    }
+
+    tp_job job;
+    while (job_queue.pop(job))
+      show_job(job);
+
+    /* Touch waiting: read it now rather than at the next indev poll */
+    if (!touch_queue.empty())
+      lv_timer_ready(lv_indev_get_read_timer(touch_indev));
+
+    uint32_t next_ms;
+    {
+      PerfTimer timer(PERF_RENDER); /* includes the flushes it triggers */
+      next_ms = lv_timer_handler(); /* let the GUI do its work */
+
+      /* Auto-off: backlight, panel and rendering */
+      if (display_on && (millis() - last_activity > SCREEN_TIMEOUT))
+        display_sleep();
+    }
+    trace_flushed(); /* before a light sleep can hold the acks back */
+
+    if (perf_report_due(millis()))
+      send_perf();
+
+    if (!display_on && io_idle && telemetry_queue.empty() &&
+        touch_queue.empty() && job_queue.empty() &&
+        millis() - last_rx_ms >= LINK_QUIET_MS) {
+      light_sleep();
+      continue;
+    }
 
+    /* Until the next LVGL timer is due, or io_task hands something over */
+    ulTaskNotifyTake(pdTRUE,
+                     pdMS_TO_TICKS(constrain(next_ms, 1, RENDER_MAX_SLEEP_MS)));
+  }
+}
+
+/* Panel, touch controller and the LVGL drivers on top of them. Shared
+ * with the host benchmarks, which run without the tasks. */
+void init_display() {
   /* Init Display */
   pinMode(TFT_BL, OUTPUT);
   digitalWrite(TFT_BL, HIGH);
   tft.init();
   tft.setRotation(1); /* Landscape */
   tft.fillScreen(TFT_BLACK);
+  tft.initDMA();
 
   /* Init Touch (separate VSPI bus) */
-  pinMode(TP_CS, OUTPUT);
-  digitalWrite(TP_CS, HIGH);
-  pinMode(TP_IRQ, INPUT);
-  touchSPI.begin(TP_CLK, TP_OUT, TP_DIN, TP_CS);
-  touchPowerDown();
+  touch.begin(TP_CLK, TP_OUT, TP_DIN);
+  touch.setCalibration(xpt_calibration_swapped(TOUCH_RAW_X_MIN, TOUCH_RAW_X_MAX,
+                                               TOUCH_RAW_Y_MIN, TOUCH_RAW_Y_MAX,
+                                               screenWidth, screenHeight));
+  touch.setOversampling(TOUCH_SAMPLES);
 
   lv_init();
-  lv_disp_draw_buf_init(&draw_buf, buf, NULL, screenWidth * 10);
+  lv_disp_draw_buf_init(&draw_buf, buf1, buf2, screenWidth * DRAW_BUF_LINES);
 
   /* Initialize the display driver */
   static lv_disp_drv_t disp_drv;
@@ -386,25 +1293,33 @@ void setup() {
   lv_indev_drv_init(&indev_drv);
   indev_drv.type = LV_INDEV_TYPE_POINTER;
   indev_drv.read_cb = my_touchpad_read;
-  lv_indev_drv_register(&indev_drv);
+  touch_indev = lv_indev_drv_register(&indev_drv);
+}
+
+void setup() {
+  tx_lock = xSemaphoreCreateMutex();
+  Serial.begin(TP_BAUD_DEFAULT);
+  Serial.onReceive(serial_rx_cb);
+  delay(500);
 
+  init_display();
   build_ui();
   last_activity = millis();
+  send_hello();
+
+  /* Wake sources for light sleep; TP_IRQ is armed per sleep */
+  esp_sleep_enable_gpio_wakeup();
+  uart_set_wakeup_threshold(UART_NUM_0, UART_WAKE_EDGES);
+  esp_sleep_enable_uart_wakeup(UART_NUM_0);
+
+  xTaskCreatePinnedToCore(render_task, "render", RENDER_STACK, NULL, 2,
+                          &render_task_handle, RENDER_CORE);
+  xTaskCreatePinnedToCore(io_task, "io", IO_STACK, NULL, 3, &io_task_handle,
+                          IO_CORE);
+  attachInterrupt(digitalPinToInterrupt(TP_IRQ), touch_irq_isr, FALLING);
 }
 
 void loop() {
-  lv_timer_handler(); /* let the GUI do its work */
-
-  /* Auto-off backlight */
-  if (display_on && (millis() - last_activity > SCREEN_TIMEOUT)) {
-    display_on = false;
-    digitalWrite(TFT_BL, LOW);
-  }
-
-  if (Serial.available()) {
-    String data = Serial.readStringUntil('\n');
-    update_stats(data);
-  }
-
-  delay(5);
-}
\ No newline at end of file
+  /* Everything runs in render_task / io_task */
+  vTaskDelete(NULL);
+}
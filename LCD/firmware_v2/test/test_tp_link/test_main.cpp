@@ -0,0 +1,91 @@
+/* =============================================
+ * TpLink (pio test -e native)
+ * =============================================
+ * Link speed fallbacks against a simulated clock and framer drop counter,
+ * including the light sleep / wake cycle of the idle display. */
+
+#include <TravelProto.h>
+#include <unity.h>
+
+#define FAST 921600
+
+void setUp() {}
+void tearDown() {}
+
+/* Offered FAST at now and every probe came back */
+static void negotiate(TpLink &link, uint32_t now, uint32_t dropped) {
+  TEST_ASSERT_TRUE(link.offer(FAST, now, dropped));
+  for (int i = 0; i < TP_BAUD_PROBES; i++)
+    link.probe();
+  TEST_ASSERT_FALSE(link.trial());
+}
+
+static void test_trial_without_probes_falls_back() {
+  TpLink link;
+  TEST_ASSERT_TRUE(link.offer(FAST, 0, 0));
+  TEST_ASSERT_EQUAL_UINT32(0, link.poll(TP_BAUD_TRIAL_MS - 1, 0));
+  TEST_ASSERT_EQUAL_UINT32(TP_BAUD_DEFAULT, link.poll(TP_BAUD_TRIAL_MS, 0));
+  TEST_ASSERT_EQUAL_UINT16(1, link.fallbacks());
+}
+
+static void test_errors_fall_back() {
+  TpLink link;
+  negotiate(link, 0, 0);
+  uint32_t dropped = 0;
+  for (int i = 1; i < TP_BAUD_MAX_ERRORS; i++)
+    TEST_ASSERT_EQUAL_UINT32(0, link.poll(i * 1000, ++dropped));
+  TEST_ASSERT_EQUAL_UINT32(TP_BAUD_DEFAULT, link.poll(5000, ++dropped));
+  TEST_ASSERT_EQUAL_UINT32(TP_BAUD_DEFAULT, link.baud());
+}
+
+static void test_errors_spread_out_are_kept() {
+  TpLink link;
+  negotiate(link, 0, 0);
+  uint32_t dropped = 0;
+  for (uint32_t t = 0; t < 10 * TP_BAUD_ERROR_WINDOW_MS;
+       t += TP_BAUD_ERROR_WINDOW_MS / 2)
+    TEST_ASSERT_EQUAL_UINT32(0, link.poll(t, ++dropped));
+  TEST_ASSERT_EQUAL_UINT32(FAST, link.baud());
+}
+
+/* Screen off: every frame wakes the UART and is cut short. None of those
+ * drops may cost the negotiated rate. */
+static void test_sleep_wake_cycles_keep_rate() {
+  TpLink link;
+  negotiate(link, 0, 0);
+  uint32_t dropped = 0;
+  for (uint32_t t = 2000; t < 60000; t += 2000) {
+    link.woke(t, dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, link.poll(t + 1, dropped));
+    dropped++; /* the wakeup frame's terminator arrives */
+    TEST_ASSERT_EQUAL_UINT32(0, link.poll(t + 10, dropped));
+    TEST_ASSERT_EQUAL_UINT32(0, link.poll(t + 500, dropped));
+  }
+  TEST_ASSERT_EQUAL_UINT32(FAST, link.baud());
+  TEST_ASSERT_EQUAL_UINT16(0, link.fallbacks());
+  TEST_ASSERT_EQUAL_UINT32(dropped, link.wakeDrops());
+}
+
+/* Only drops within the grace after a wakeup are excused */
+static void test_drops_after_grace_count() {
+  TpLink link;
+  negotiate(link, 0, 0);
+  uint32_t dropped = 0;
+  link.woke(1000, dropped);
+  TEST_ASSERT_EQUAL_UINT32(0, link.poll(1010, ++dropped));
+  TEST_ASSERT_EQUAL_UINT32(0, link.poll(1000 + TP_BAUD_WAKE_GRACE_MS, dropped));
+  for (int i = 1; i < TP_BAUD_MAX_ERRORS; i++)
+    TEST_ASSERT_EQUAL_UINT32(0, link.poll(2000 + i, ++dropped));
+  TEST_ASSERT_EQUAL_UINT32(TP_BAUD_DEFAULT, link.poll(3000, ++dropped));
+  TEST_ASSERT_EQUAL_UINT32(1, link.wakeDrops());
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_trial_without_probes_falls_back);
+  RUN_TEST(test_errors_fall_back);
+  RUN_TEST(test_errors_spread_out_are_kept);
+  RUN_TEST(test_sleep_wake_cycles_keep_rate);
+  RUN_TEST(test_drops_after_grace_count);
+  return UNITY_END();
+}
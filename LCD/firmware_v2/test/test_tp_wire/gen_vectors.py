@@ -0,0 +1,138 @@
+"""Generates wire_vectors.h: frames encoded by the bridge's protocol.py,
+for test_main.cpp to decode with TpFramer / tp_decode_telemetry.
+
+Output (checked in, so the test also builds without this script):
+
+    LCD/firmware_v2/test/test_tp_wire/wire_vectors.h
+
+PlatformIO runs it before every native build through extra_scripts, so
+a change to the field table on either side fails `pio test -e native`.
+Run by hand with --check to only report a stale header.
+"""
+import os
+import sys
+
+try:
+    Import("env")  # noqa: F821 - defined when run by PlatformIO (SCons)
+    LCD_DIR = os.path.normpath(os.path.join(env.subst("$PROJECT_DIR"), ".."))  # noqa: F821
+except NameError:
+    LCD_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", ".."))
+
+sys.path.insert(0, os.path.join(LCD_DIR, "bridge"))
+import protocol  # noqa: E402
+
+HEADER = os.path.join(LCD_DIR, "firmware_v2", "test", "test_tp_wire", "wire_vectors.h")
+
+# Values the wire carries exactly (tenths, whole MB / GB)
+STATS = {
+    "cpu": 37.5,
+    "ram": {"percent": 61.2, "used": 2506, "total": 4096},
+    "disk": {"percent": 48.0, "used": 14, "total": 29},
+    "temp": -3.5,
+    "uptime": 987654,
+    "net": {"wlan0": "192.168.4.1", "wlan1": "10.0.0.23", "eth0": None, "usb0": "172.20.10.2"},
+    "traffic": {"uplink": {"rx": 1250000, "tx": 80000, "drops": 0.5},
+                "hotspot": {"rx": 4096, "tx": 70000000, "drops": 0.0}},
+}
+
+# STATS after an update: cpu, temp, wlan1 and uplink moved
+UPDATE = dict(STATS, cpu=99.9, temp=71.3,
+              net=dict(STATS["net"], wlan1="10.0.0.99"),
+              traffic=dict(STATS["traffic"], uplink={"rx": 0, "tx": 12, "drops": 2.5}))
+UPDATE_MASK = sum(1 << protocol.FIELDS.index(f) for f in ("cpu", "temp", "wlan1", "uplink"))
+
+
+def body(frame):
+    """frame (with its 0x00) -> version, type, payload, crc"""
+    return bytearray(protocol.cobs_decode(frame[:-1]))
+
+
+def frame(raw):
+    return protocol.cobs_encode(bytes(raw)) + b'\x00'
+
+
+def vectors():
+    keyframe = protocol.encode_telemetry(STATS)
+    payload = bytes(body(keyframe)[2:-2])
+
+    bad_crc = body(keyframe)
+    bad_crc[-1] ^= 0x01
+    bad_version = body(keyframe)
+    bad_version[0] = protocol.PROTO_VERSION + 1
+    bad_version[-2:] = protocol.crc16(bad_version[:-2]).to_bytes(2, 'little')
+
+    return (
+        ("keyframe", keyframe),
+        ("delta", protocol.encode_delta(UPDATE, UPDATE_MASK)),
+        ("bad_crc", frame(bad_crc)),
+        ("bad_version", frame(bad_version)),
+        # A bridge from before the traffic fields
+        ("legacy", protocol.encode_frame(protocol.MSG_TELEMETRY, payload[:36])),
+        ("short", protocol.encode_frame(protocol.MSG_TELEMETRY, payload[:35])),
+    )
+
+
+def c_bytes(data):
+    rows = [", ".join(f"0x{b:02X}" for b in data[i:i + 12]) for i in range(0, len(data), 12)]
+    return "{\n    " + ",\n    ".join(rows) + "}"
+
+
+def c_ip(addr):
+    return "{" + ", ".join(str(b) for b in protocol._ip(addr)) + "}"
+
+
+def c_telemetry(name, stats):
+    ram, disk, net, traffic = stats["ram"], stats["disk"], stats["net"], stats["traffic"]
+    rates = ", ".join("{%du, %du, %.1ff}" % (t["rx"], t["tx"], t["drops"])
+                      for t in (traffic[role] for role in protocol.RATES))
+    return (f"static const tp_telemetry {name} = {{\n"
+            f"    {stats['cpu']:.1f}f, {ram['percent']:.1f}f, {ram['used']}, {ram['total']},\n"
+            f"    {disk['percent']:.1f}f, {disk['used']}, {disk['total']}, {stats['temp']:.1f}f, "
+            f"{stats['uptime']}u,\n"
+            f"    {{{', '.join(c_ip(net.get(i)) for i in protocol.IFACES)}}},\n"
+            f"    {rates}}};")
+
+
+def header():
+    out = [
+        "// GENERATED from LCD/bridge/protocol.py by gen_vectors.py; do not edit.",
+        "#pragma once",
+        "",
+        "#include <TravelProto.h>",
+        "",
+        f"#define PY_PROTO_VERSION {protocol.PROTO_VERSION}",
+        f"#define PY_TELEMETRY_SIZE {protocol.TELEMETRY_STRUCT.size}",
+        f"#define PY_FIELD_COUNT {len(protocol.FIELDS)}",
+        f"#define PY_UPDATE_MASK 0x{UPDATE_MASK:04X}",
+        "",
+        "// What STATS and UPDATE decode to",
+        c_telemetry("py_stats", STATS),
+        c_telemetry("py_update", UPDATE),
+    ]
+    for name, data in vectors():
+        out += ["", f"static const uint8_t py_{name}[] = {c_bytes(data)};"]
+    out.append("")
+    return "\n".join(out)
+
+
+def generate(check=False):
+    """Rewrite the header if it is stale; returns whether it was."""
+    text = header()
+    try:
+        with open(HEADER) as f:
+            stale = f.read() != text
+    except FileNotFoundError:
+        stale = True
+    if stale and not check:
+        with open(HEADER, "w") as f:
+            f.write(text)
+    return stale
+
+
+if __name__ == "__main__":
+    check = "--check" in sys.argv[1:]
+    if generate(check):
+        print(f"{'stale' if check else 'wrote'}: {os.path.relpath(HEADER, LCD_DIR)}")
+        sys.exit(1 if check else 0)
+else:
+    generate()
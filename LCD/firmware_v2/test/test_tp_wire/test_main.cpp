@@ -0,0 +1,150 @@
+/* =============================================
+ * Wire format (pio test -e native)
+ * =============================================
+ * Frames encoded by the bridge (wire_vectors.h, generated from
+ * LCD/bridge/protocol.py by gen_vectors.py), decoded with TpFramer and
+ * tp_decode_telemetry. */
+
+#include <TravelProto.h>
+#include <string.h>
+#include <unity.h>
+
+#include "wire_vectors.h"
+
+void setUp() {}
+void tearDown() {}
+
+/* Push a whole frame; only its last byte may complete it */
+static tp_frame_kind feed(TpFramer &framer, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i + 1 < len; i++)
+    TEST_ASSERT_EQUAL(TP_FRAME_NONE, framer.push(data[i]));
+  return framer.push(data[len - 1]);
+}
+
+#define FEED(framer, v) feed(framer, v, sizeof(v))
+
+static bool decode(const TpFramer &framer, tp_telemetry &model,
+                   uint16_t &changed) {
+  return tp_decode_telemetry(framer.type(), framer.payload(),
+                             framer.payloadLength(), model, changed);
+}
+
+static void assert_traffic(const tp_traffic &want, const tp_traffic &got) {
+  TEST_ASSERT_EQUAL_UINT32(want.rx, got.rx);
+  TEST_ASSERT_EQUAL_UINT32(want.tx, got.tx);
+  TEST_ASSERT_EQUAL_FLOAT(want.drops, got.drops);
+}
+
+static void assert_model(const tp_telemetry &want, const tp_telemetry &got) {
+  TEST_ASSERT_EQUAL_FLOAT(want.cpu, got.cpu);
+  TEST_ASSERT_EQUAL_FLOAT(want.ram_percent, got.ram_percent);
+  TEST_ASSERT_EQUAL_UINT16(want.ram_used, got.ram_used);
+  TEST_ASSERT_EQUAL_UINT16(want.ram_total, got.ram_total);
+  TEST_ASSERT_EQUAL_FLOAT(want.disk_percent, got.disk_percent);
+  TEST_ASSERT_EQUAL_UINT16(want.disk_used, got.disk_used);
+  TEST_ASSERT_EQUAL_UINT16(want.disk_total, got.disk_total);
+  TEST_ASSERT_EQUAL_FLOAT(want.temp, got.temp);
+  TEST_ASSERT_EQUAL_UINT32(want.uptime, got.uptime);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(want.ip, got.ip, sizeof(want.ip));
+  assert_traffic(want.uplink, got.uplink);
+  assert_traffic(want.hotspot, got.hotspot);
+}
+
+static void test_field_table_matches() {
+  TEST_ASSERT_EQUAL(TP_VERSION, PY_PROTO_VERSION);
+  TEST_ASSERT_EQUAL(TP_TELEMETRY_SIZE, PY_TELEMETRY_SIZE);
+  TEST_ASSERT_EQUAL(TP_FIELD_COUNT, PY_FIELD_COUNT);
+}
+
+static void test_keyframe() {
+  TpFramer framer;
+  tp_telemetry model = {};
+  uint16_t changed;
+  TEST_ASSERT_EQUAL(TP_FRAME_BINARY, FEED(framer, py_keyframe));
+  TEST_ASSERT_EQUAL_UINT8(TP_MSG_TELEMETRY, framer.type());
+  TEST_ASSERT_EQUAL(TP_TELEMETRY_SIZE, framer.payloadLength());
+  TEST_ASSERT_TRUE(decode(framer, model, changed));
+  /* eth0 is down, as in the zeroed model */
+  TEST_ASSERT_EQUAL_HEX16(TP_F_ALL & ~(TP_F_IP0 << TP_IF_ETH0), changed);
+  assert_model(py_stats, model);
+}
+
+static void test_delta() {
+  TpFramer framer;
+  tp_telemetry model = py_stats;
+  uint16_t changed;
+  TEST_ASSERT_EQUAL(TP_FRAME_BINARY, FEED(framer, py_delta));
+  TEST_ASSERT_EQUAL_UINT8(TP_MSG_TELEMETRY_DELTA, framer.type());
+  TEST_ASSERT_TRUE(decode(framer, model, changed));
+  TEST_ASSERT_EQUAL_HEX16(PY_UPDATE_MASK, changed);
+  assert_model(py_update, model);
+}
+
+/* Dropped and counted; the next frame still decodes */
+static void test_bad_crc_dropped() {
+  TpFramer framer;
+  TEST_ASSERT_EQUAL(TP_FRAME_NONE, FEED(framer, py_bad_crc));
+  TEST_ASSERT_EQUAL_UINT32(1, framer.dropped());
+  TEST_ASSERT_EQUAL(TP_FRAME_BINARY, FEED(framer, py_keyframe));
+}
+
+static void test_bad_version_dropped() {
+  TpFramer framer;
+  TEST_ASSERT_EQUAL(TP_FRAME_NONE, FEED(framer, py_bad_version));
+  TEST_ASSERT_EQUAL_UINT32(1, framer.dropped());
+}
+
+/* TP_TELEMETRY_MIN_SIZE bytes: everything but traffic, which is kept */
+static void test_legacy_keyframe() {
+  TpFramer framer;
+  tp_telemetry model = {};
+  model.uplink = py_update.uplink;
+  uint16_t changed;
+  TEST_ASSERT_EQUAL(TP_FRAME_BINARY, FEED(framer, py_legacy));
+  TEST_ASSERT_EQUAL(TP_TELEMETRY_MIN_SIZE, framer.payloadLength());
+  TEST_ASSERT_TRUE(decode(framer, model, changed));
+  TEST_ASSERT_EQUAL_HEX16(0, changed & TP_F_TRAFFIC);
+  TEST_ASSERT_EQUAL_FLOAT(py_stats.cpu, model.cpu);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(py_stats.ip, model.ip, sizeof(model.ip));
+  assert_traffic(py_update.uplink, model.uplink);
+}
+
+/* Intact frame, too short a keyframe: rejected without touching the model */
+static void test_short_keyframe_rejected() {
+  TpFramer framer;
+  tp_telemetry model = py_update;
+  uint16_t changed;
+  TEST_ASSERT_EQUAL(TP_FRAME_BINARY, FEED(framer, py_short));
+  TEST_ASSERT_FALSE(decode(framer, model, changed));
+  TEST_ASSERT_EQUAL_MEMORY(&py_update, &model, sizeof(model));
+}
+
+/* Frames and a JSON line back to back, as the bridge writes them */
+static void test_mixed_stream() {
+  static const char line[] = "{\"cpu\":1}\n";
+  TpFramer framer;
+  tp_telemetry model = {};
+  uint16_t changed;
+  TEST_ASSERT_EQUAL(TP_FRAME_BINARY, FEED(framer, py_keyframe));
+  TEST_ASSERT_TRUE(decode(framer, model, changed));
+  TEST_ASSERT_EQUAL(TP_FRAME_JSON,
+                    feed(framer, (const uint8_t *)line, sizeof(line) - 1));
+  TEST_ASSERT_EQUAL_STRING("{\"cpu\":1}", framer.line());
+  TEST_ASSERT_EQUAL(TP_FRAME_BINARY, FEED(framer, py_delta));
+  TEST_ASSERT_TRUE(decode(framer, model, changed));
+  assert_model(py_update, model);
+  TEST_ASSERT_EQUAL_UINT32(0, framer.dropped());
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_field_table_matches);
+  RUN_TEST(test_keyframe);
+  RUN_TEST(test_delta);
+  RUN_TEST(test_bad_crc_dropped);
+  RUN_TEST(test_bad_version_dropped);
+  RUN_TEST(test_legacy_keyframe);
+  RUN_TEST(test_short_keyframe_rejected);
+  RUN_TEST(test_mixed_stream);
+  return UNITY_END();
+}
@@ -0,0 +1,62 @@
+// GENERATED from LCD/bridge/protocol.py by gen_vectors.py; do not edit.
+#pragma once
+
+#include <TravelProto.h>
+
+#define PY_PROTO_VERSION 1
+#define PY_TELEMETRY_SIZE 56
+#define PY_FIELD_COUNT 15
+#define PY_UPDATE_MASK 0x2481
+
+// What STATS and UPDATE decode to
+static const tp_telemetry py_stats = {
+    37.5f, 61.2f, 2506, 4096,
+    48.0f, 14, 29, -3.5f, 987654u,
+    {{192, 168, 4, 1}, {10, 0, 0, 23}, {0, 0, 0, 0}, {172, 20, 10, 2}},
+    {1250000u, 80000u, 0.5f}, {4096u, 70000000u, 0.0f}};
+static const tp_telemetry py_update = {
+    99.9f, 61.2f, 2506, 4096,
+    48.0f, 14, 29, 71.3f, 987654u,
+    {{192, 168, 4, 1}, {10, 0, 0, 99}, {0, 0, 0, 0}, {172, 20, 10, 2}},
+    {0u, 12u, 2.5f}, {4096u, 70000000u, 0.0f}};
+
+static const uint8_t py_keyframe[] = {
+    0x09, 0x01, 0x01, 0x77, 0x01, 0x64, 0x02, 0xCA, 0x09, 0x05, 0x10, 0xE0,
+    0x01, 0x0E, 0x02, 0x1D, 0x06, 0xDD, 0xFF, 0x06, 0x12, 0x0F, 0x06, 0xC0,
+    0xA8, 0x04, 0x01, 0x0A, 0x01, 0x02, 0x17, 0x01, 0x01, 0x01, 0x08, 0xAC,
+    0x14, 0x0A, 0x02, 0xD0, 0x12, 0x13, 0x04, 0x80, 0x38, 0x01, 0x02, 0x05,
+    0x01, 0x02, 0x10, 0x01, 0x05, 0x80, 0x1D, 0x2C, 0x04, 0x01, 0x03, 0x15,
+    0x3B, 0x00};
+
+static const uint8_t py_delta[] = {
+    0x0A, 0x01, 0x02, 0x81, 0x24, 0xE7, 0x03, 0xC9, 0x02, 0x0A, 0x01, 0x02,
+    0x63, 0x01, 0x01, 0x01, 0x02, 0x0C, 0x01, 0x01, 0x02, 0x19, 0x03, 0x35,
+    0x5F, 0x00};
+
+static const uint8_t py_bad_crc[] = {
+    0x09, 0x01, 0x01, 0x77, 0x01, 0x64, 0x02, 0xCA, 0x09, 0x05, 0x10, 0xE0,
+    0x01, 0x0E, 0x02, 0x1D, 0x06, 0xDD, 0xFF, 0x06, 0x12, 0x0F, 0x06, 0xC0,
+    0xA8, 0x04, 0x01, 0x0A, 0x01, 0x02, 0x17, 0x01, 0x01, 0x01, 0x08, 0xAC,
+    0x14, 0x0A, 0x02, 0xD0, 0x12, 0x13, 0x04, 0x80, 0x38, 0x01, 0x02, 0x05,
+    0x01, 0x02, 0x10, 0x01, 0x05, 0x80, 0x1D, 0x2C, 0x04, 0x01, 0x03, 0x15,
+    0x3A, 0x00};
+
+static const uint8_t py_bad_version[] = {
+    0x09, 0x02, 0x01, 0x77, 0x01, 0x64, 0x02, 0xCA, 0x09, 0x05, 0x10, 0xE0,
+    0x01, 0x0E, 0x02, 0x1D, 0x06, 0xDD, 0xFF, 0x06, 0x12, 0x0F, 0x06, 0xC0,
+    0xA8, 0x04, 0x01, 0x0A, 0x01, 0x02, 0x17, 0x01, 0x01, 0x01, 0x08, 0xAC,
+    0x14, 0x0A, 0x02, 0xD0, 0x12, 0x13, 0x04, 0x80, 0x38, 0x01, 0x02, 0x05,
+    0x01, 0x02, 0x10, 0x01, 0x05, 0x80, 0x1D, 0x2C, 0x04, 0x01, 0x03, 0xCE,
+    0x92, 0x00};
+
+static const uint8_t py_legacy[] = {
+    0x09, 0x01, 0x01, 0x77, 0x01, 0x64, 0x02, 0xCA, 0x09, 0x05, 0x10, 0xE0,
+    0x01, 0x0E, 0x02, 0x1D, 0x06, 0xDD, 0xFF, 0x06, 0x12, 0x0F, 0x06, 0xC0,
+    0xA8, 0x04, 0x01, 0x0A, 0x01, 0x02, 0x17, 0x01, 0x01, 0x01, 0x07, 0xAC,
+    0x14, 0x0A, 0x02, 0x5E, 0x33, 0x00};
+
+static const uint8_t py_short[] = {
+    0x09, 0x01, 0x01, 0x77, 0x01, 0x64, 0x02, 0xCA, 0x09, 0x05, 0x10, 0xE0,
+    0x01, 0x0E, 0x02, 0x1D, 0x06, 0xDD, 0xFF, 0x06, 0x12, 0x0F, 0x06, 0xC0,
+    0xA8, 0x04, 0x01, 0x0A, 0x01, 0x02, 0x17, 0x01, 0x01, 0x01, 0x06, 0xAC,
+    0x14, 0x0A, 0xC0, 0x95, 0x00};
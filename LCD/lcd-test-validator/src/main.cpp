@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <TFT_eSPI.h>
+#include <Xpt2046.h>
 
 // ---- CORRECT PINOUT from board diagram ----
 // Touch has its OWN SPI bus, separate from TFT!
@@ -12,28 +13,14 @@
 
 TFT_eSPI tft = TFT_eSPI();
 SPIClass touchSPI(VSPI);
+Xpt2046 touch(touchSPI, TP_CS, TP_IRQ);
 
-// Raw SPI read from XPT2046
-uint16_t touchReadChannel(uint8_t cmd) {
-  touchSPI.beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-  digitalWrite(TP_CS, LOW);
-  touchSPI.transfer(cmd);
-  uint8_t hi = touchSPI.transfer(0);
-  uint8_t lo = touchSPI.transfer(0);
-  digitalWrite(TP_CS, HIGH);
-  touchSPI.endTransaction();
-  return ((hi << 8) | lo) >> 3;
-}
-
-void touchPowerDown() {
-  touchSPI.beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-  digitalWrite(TP_CS, LOW);
-  touchSPI.transfer(0x80);
-  touchSPI.transfer(0);
-  touchSPI.transfer(0);
-  digitalWrite(TP_CS, HIGH);
-  touchSPI.endTransaction();
-}
+// Map with swapped axes (common on CYD boards):
+// screen X from rawY, screen Y from rawX
+#define TOUCH_RAW_X_MIN 300
+#define TOUCH_RAW_X_MAX 3700
+#define TOUCH_RAW_Y_MIN 200
+#define TOUCH_RAW_Y_MAX 3800
 
 void drawCrosshair(int x, int y, uint16_t color) {
   tft.drawLine(x - 8, y, x + 8, y, color);
@@ -65,41 +52,30 @@ void setup() {
   drawCrosshair(300, 220, TFT_RED);    // Bottom-right
 
   // Init Touch
-  pinMode(TP_CS, OUTPUT);
-  digitalWrite(TP_CS, HIGH);
-  pinMode(TP_IRQ, INPUT);
-  touchSPI.begin(TP_CLK, TP_OUT, TP_DIN, TP_CS);
-  touchPowerDown();
+  touch.begin(TP_CLK, TP_OUT, TP_DIN);
+  touch.setCalibration(xpt_calibration_swapped(
+      TOUCH_RAW_X_MIN, TOUCH_RAW_X_MAX, TOUCH_RAW_Y_MIN, TOUCH_RAW_Y_MAX, 320,
+      240));
+  touch.setOversampling(5); // steadier raw readings for calibrating
 
   Serial.println("[BOOT] Ready. Touch the crosshairs!");
   Serial.println("---");
 }
 
 void loop() {
-  if (digitalRead(TP_IRQ) == LOW) {
-    uint16_t z1 = touchReadChannel(0xB1);
-    uint16_t z2 = touchReadChannel(0xC1);
-    int z = z1 + 4095 - z2;
-
-    if (z > 400) {
-      // Read raw X and Y (XPT2046 commands: X=0xD0, Y=0x90)
-      uint16_t rawX = touchReadChannel(0xD1);
-      uint16_t rawY = touchReadChannel(0x91);
-
+  xpt_raw raw;
+  if (touch.touched()) {
+    if (touch.readRaw(raw)) {
       // Print raw values
       Serial.print("[TOUCH] rawX=");
-      Serial.print(rawX);
+      Serial.print(raw.x);
       Serial.print(" rawY=");
-      Serial.print(rawY);
+      Serial.print(raw.y);
       Serial.print(" Z=");
-      Serial.println(z);
+      Serial.println(raw.z);
 
-      // Map with swapped axes (common on CYD boards)
-      // Try: screen X from rawY, screen Y from rawX (swapped + inverted)
-      int screenX = map(rawY, 200, 3800, 0, 320);
-      int screenY = map(rawX, 300, 3700, 0, 240);
-      screenX = constrain(screenX, 0, 319);
-      screenY = constrain(screenY, 0, 239);
+      int screenX, screenY;
+      touch.toScreen(raw, screenX, screenY);
 
       // Draw dot + show raw coords on screen
       tft.fillCircle(screenX, screenY, 3, TFT_WHITE);
@@ -110,12 +86,11 @@ void loop() {
       tft.setTextSize(1);
       tft.setCursor(5, 230);
       char buf[60];
-      snprintf(buf, sizeof(buf), "Raw: X=%d Y=%d  Screen: %d,%d", rawX, rawY,
+      snprintf(buf, sizeof(buf), "Raw: X=%d Y=%d  Screen: %d,%d", raw.x, raw.y,
                screenX, screenY);
       tft.print(buf);
     }
 
-    touchPowerDown();
     delay(50);
   }
 }
@@ -0,0 +1,73 @@
+#include "PerfCounters.h"
+
+#include <Arduino.h>
+
+const char *const perf_slot_names[PERF_SLOT_COUNT] = {"parse", "render",
+                                                      "flush", "touch"};
+
+PerfStat perf_stats[PERF_SLOT_COUNT];
+
+static std::atomic<uint32_t> frames{0}, frameBytes{0};
+static uint32_t windowStart = 0;
+
+uint32_t perf_cycles() { return ESP.getCycleCount(); }
+
+void PerfStat::add(uint32_t cycles) {
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_.fetch_add(cycles, std::memory_order_relaxed);
+  uint32_t prev = max_.load(std::memory_order_relaxed);
+  while (cycles > prev &&
+         !max_.compare_exchange_weak(prev, cycles, std::memory_order_relaxed))
+    ;
+}
+
+void PerfStat::take(uint32_t &count, uint32_t &total, uint32_t &max) {
+  count = count_.exchange(0, std::memory_order_relaxed);
+  total = total_.exchange(0, std::memory_order_relaxed);
+  max = max_.exchange(0, std::memory_order_relaxed);
+}
+
+void perf_frame(uint32_t bytes) {
+  frames.fetch_add(1, std::memory_order_relaxed);
+  frameBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+bool perf_report_due(uint32_t now_ms) {
+  return PERF_REPORT_MS && now_ms - windowStart >= PERF_REPORT_MS;
+}
+
+size_t perf_format_report(char *buf, size_t size, uint32_t now_ms,
+                          const char *extra) {
+  uint32_t window = now_ms - windowStart;
+  windowStart = now_ms;
+  if (window == 0)
+    window = 1;
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  uint32_t nFrames = frames.exchange(0, std::memory_order_relaxed);
+  uint32_t nBytes = frameBytes.exchange(0, std::memory_order_relaxed);
+
+  // {"perf":{"ms":..,"fps":..,"bytes":..,"heap":[free,min],
+  //          "t":{"<slot>":[count,avg_us,max_us],...}[,extra]}}
+  size_t n = snprintf(buf, size,
+                      "{\"perf\":{\"ms\":%lu,\"fps\":%.1f,\"bytes\":%lu,"
+                      "\"heap\":[%lu,%lu],\"t\":{",
+                      (unsigned long)window, nFrames * 1000.0f / window,
+                      (unsigned long)nBytes, (unsigned long)ESP.getFreeHeap(),
+                      (unsigned long)ESP.getMinFreeHeap());
+  bool first = true;
+  for (int i = 0; i < PERF_SLOT_COUNT; i++) {
+    uint32_t count, total, max;
+    perf_stats[i].take(count, total, max);
+    if (!count || n >= size)
+      continue; // section not used by this firmware / window
+    n += snprintf(buf + n, size - n, "%s\"%s\":[%lu,%lu,%lu]",
+                  first ? "" : ",", perf_slot_names[i], (unsigned long)count,
+                  (unsigned long)(total / count / mhz),
+                  (unsigned long)(max / mhz));
+    first = false;
+  }
+  if (n < size)
+    n += snprintf(buf + n, size - n, "}%s%s}}\n", extra ? "," : "",
+                  extra ? extra : "");
+  return n < size ? n : 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================
+// ON-DEVICE PERFORMANCE COUNTERS
+// =============================================
+// Section timers on the CPU cycle counter, a frame counter and heap
+// figures, summarised into a {"perf":{...}} JSON line every
+// PERF_REPORT_MS. Timing a section costs two cycle-counter reads and
+// three relaxed atomics, so the timers stay compiled in.
+//
+// The cycle counter is per core: start and stop a timer in the same task
+// (the firmware tasks are pinned, so that is always the case).
+
+// Report interval; 0 disables the report (the counters still run)
+#ifndef PERF_REPORT_MS
+#define PERF_REPORT_MS 10000
+#endif
+
+// Section totals are 32-bit cycle counts: ~17 s of busy time at 240 MHz
+#if PERF_REPORT_MS > 15000
+#error "PERF_REPORT_MS too long for 32-bit cycle totals"
+#endif
+
+enum perf_slot : uint8_t {
+  PERF_PARSE = 0, // decoding one telemetry frame / JSON line
+  PERF_RENDER,    // one UI update pass (LVGL: lv_timer_handler)
+  PERF_FLUSH,     // handing one band to the panel
+  PERF_TOUCH,     // one touch controller sample
+  PERF_SLOT_COUNT
+};
+
+extern const char *const perf_slot_names[PERF_SLOT_COUNT];
+
+uint32_t perf_cycles();
+
+// Count / total / worst of one section over the current report window.
+// Any task may add(); take() reads and restarts the window.
+class PerfStat {
+public:
+  void add(uint32_t cycles);
+  void take(uint32_t &count, uint32_t &total, uint32_t &max);
+
+private:
+  std::atomic<uint32_t> count_{0}, total_{0}, max_{0};
+};
+
+extern PerfStat perf_stats[PERF_SLOT_COUNT];
+
+// Times the enclosing scope into a slot
+class PerfTimer {
+public:
+  explicit PerfTimer(perf_slot slot) : slot_(slot), start_(perf_cycles()) {}
+  ~PerfTimer() { perf_stats[slot_].add(perf_cycles() - start_); }
+
+private:
+  perf_slot slot_;
+  uint32_t start_;
+};
+
+// A complete frame reached the panel, carrying this many bytes
+void perf_frame(uint32_t bytes);
+
+// True once PERF_REPORT_MS has passed since the last report
+bool perf_report_due(uint32_t now_ms);
+
+// Formats the report for the window since the last call and restarts it.
+// extra (may be NULL) is spliced in as additional members, e.g.
+// "\"lv\":[...]". Returns the line length including '\n', 0 if it did
+// not fit.
+size_t perf_format_report(char *buf, size_t size, uint32_t now_ms,
+                          const char *extra);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================
+// LOCK-FREE SINGLE-PRODUCER / SINGLE-CONSUMER QUEUE
+// =============================================
+// Fixed capacity, no heap. Exactly one context may push (e.g. the UART
+// event task or an ISR) and exactly one may pop (e.g. loop()). N must be a
+// power of two; one slot is kept free to tell full from empty.
+template <typename T, size_t N> class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+  SpscQueue() : head_(0), tail_(0), overruns_(0) {}
+
+  // Producer side. Returns false (and counts an overrun) when full.
+  bool push(const T &item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t next = (head + 1) & (N - 1);
+    if (next == tail_.load(std::memory_order_acquire)) {
+      overruns_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    items_[head] = item;
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when empty.
+  bool pop(T &item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+      return false;
+    item = items_[tail];
+    tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    return (head_.load(std::memory_order_acquire) -
+            tail_.load(std::memory_order_acquire)) &
+           (N - 1);
+  }
+
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N - 1; }
+  uint32_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+private:
+  T items_[N];
+  std::atomic<size_t> head_;
+  std::atomic<size_t> tail_;
+  std::atomic<uint32_t> overruns_;
+};
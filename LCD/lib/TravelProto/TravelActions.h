@@ -0,0 +1,27 @@
+// GENERATED from LCD/actions/actions.json by gen_actions.py; do not edit.
+#pragma once
+
+#include "TravelProto.h"
+
+enum tp_opcode : uint8_t {
+  TP_OP_RESET_NETWORK = 1,
+  TP_OP_FW_STRICT = 2,
+  TP_OP_FW_MAINT = 3,
+  TP_OP_START_SMB = 4,
+  TP_OP_STOP_SMB = 5,
+  TP_OP_REBOOT = 6,
+  TP_OP_SHUTDOWN = 7,
+};
+
+#define TP_ACTION_COUNT 7
+
+// In button order
+static const tp_action tp_actions[TP_ACTION_COUNT] = {
+    {TP_OP_RESET_NETWORK, "reset_network", "Reset Net", 0xFC6000, 0xFB00, true},
+    {TP_OP_FW_STRICT, "fw_strict", "FW Strict", 0xD00000, 0xD000, true},
+    {TP_OP_FW_MAINT, "fw_maint", "FW Maint", 0xC8A000, 0xCD00, true},
+    {TP_OP_START_SMB, "start_smb", "Start SMB", 0x00804A, 0x0409, true},
+    {TP_OP_STOP_SMB, "stop_smb", "Stop SMB", 0xD00000, 0xD000, true},
+    {TP_OP_REBOOT, "reboot", "Reboot", 0xFC6000, 0xFB00, true},
+    {TP_OP_SHUTDOWN, "shutdown", "Shutdown", 0x800020, 0x8004, true},
+};
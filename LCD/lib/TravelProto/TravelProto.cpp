@@ -0,0 +1,415 @@
+#include "TravelProto.h"
+
+#include <stdio.h>
+#include <string.h>
+
+const char *const tp_if_names[TP_IF_COUNT] = {"wlan0", "wlan1", "eth0",
+                                              "usb0"};
+
+// =============================================
+// CRC / COBS
+// =============================================
+uint16_t tp_crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (int i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+size_t tp_cobs_encode(const uint8_t *data, size_t len, uint8_t *out) {
+  size_t code = 0, wr = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] == 0) {
+      out[code] = wr - code;
+      code = wr++;
+    } else {
+      out[wr++] = data[i];
+    }
+  }
+  out[code] = wr - code;
+  return wr;
+}
+
+size_t tp_cobs_decode(uint8_t *buf, size_t len) {
+  size_t rd = 0, wr = 0;
+  while (rd < len) {
+    uint8_t code = buf[rd++];
+    if (code == 0 || rd + code - 1 > len)
+      return 0;
+    for (uint8_t i = 1; i < code; i++)
+      buf[wr++] = buf[rd++];
+    if (code != 0xFF && rd < len)
+      buf[wr++] = 0;
+  }
+  return wr;
+}
+
+// =============================================
+// PAYLOAD DECODING
+// =============================================
+static uint16_t rd16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t rd32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+// Wire size of each field, in tp_field bit order
+static const uint8_t FIELD_SIZE[TP_FIELD_COUNT] = {2, 2, 2, 2, 2, 2, 2, 2,
+                                                  4, 4, 4, 4, 4, 10, 10};
+
+// [rx u32][tx u32][drops x10 u16]
+static void apply_traffic(const uint8_t *p, tp_traffic &t, uint16_t bit,
+                          uint16_t &changed) {
+  tp_traffic v = {rd32(p), rd32(p + 4), rd16(p + 8) / 10.0f};
+  if (v.rx != t.rx || v.tx != t.tx || v.drops != t.drops) {
+    t = v;
+    changed |= bit;
+  }
+}
+
+static void apply_field(int i, const uint8_t *p, tp_telemetry &m,
+                        uint16_t &changed) {
+  uint16_t bit = 1 << i;
+  switch (i) {
+  case 0: tp_set(m.cpu, rd16(p) / 10.0f, bit, changed); break;
+  case 1: tp_set(m.ram_percent, rd16(p) / 10.0f, bit, changed); break;
+  case 2: tp_set(m.ram_used, rd16(p), bit, changed); break;
+  case 3: tp_set(m.ram_total, rd16(p), bit, changed); break;
+  case 4: tp_set(m.disk_percent, rd16(p) / 10.0f, bit, changed); break;
+  case 5: tp_set(m.disk_used, rd16(p), bit, changed); break;
+  case 6: tp_set(m.disk_total, rd16(p), bit, changed); break;
+  case 7: tp_set(m.temp, (int16_t)rd16(p) / 10.0f, bit, changed); break;
+  case 8: tp_set(m.uptime, rd32(p), bit, changed); break;
+  case 13: apply_traffic(p, m.uplink, bit, changed); break;
+  case 14: apply_traffic(p, m.hotspot, bit, changed); break;
+  default: {
+    uint8_t *ip = m.ip[i - 9];
+    if (memcmp(ip, p, 4) != 0) {
+      memcpy(ip, p, 4);
+      changed |= bit;
+    }
+  }
+  }
+}
+
+bool tp_decode_telemetry(uint8_t type, const uint8_t *p, size_t len,
+                         tp_telemetry &model, uint16_t &changed) {
+  uint16_t mask;
+  if (type == TP_MSG_TELEMETRY) {
+    // Take the known fields that are present: older bridges stop short,
+    // newer ones may append fields we ignore
+    if (len < TP_TELEMETRY_MIN_SIZE)
+      return false;
+    mask = 0;
+    size_t size = 0;
+    for (int i = 0; i < TP_FIELD_COUNT && size + FIELD_SIZE[i] <= len; i++) {
+      size += FIELD_SIZE[i];
+      mask |= 1 << i;
+    }
+  } else if (type == TP_MSG_TELEMETRY_DELTA) {
+    if (len < 2)
+      return false;
+    mask = rd16(p);
+    p += 2;
+    len -= 2;
+  } else {
+    return false;
+  }
+
+  // Validate the length before touching the model
+  size_t need = 0;
+  for (int i = 0; i < TP_FIELD_COUNT; i++)
+    if (mask & (1 << i))
+      need += FIELD_SIZE[i];
+  if (len < need)
+    return false;
+
+  changed = 0;
+  for (int i = 0; i < TP_FIELD_COUNT; i++) {
+    if (mask & (1 << i)) {
+      apply_field(i, p, model, changed);
+      p += FIELD_SIZE[i];
+    }
+  }
+  return true;
+}
+
+bool tp_ip_valid(const uint8_t ip[4]) {
+  return ip[0] | ip[1] | ip[2] | ip[3];
+}
+
+void tp_parse_ip(const char *s, uint8_t out[4]) {
+  memset(out, 0, 4);
+  if (!s)
+    return;
+  uint8_t tmp[4];
+  for (int i = 0; i < 4; i++) {
+    if (*s < '0' || *s > '9')
+      return;
+    unsigned v = 0;
+    while (*s >= '0' && *s <= '9')
+      v = v * 10 + (*s++ - '0');
+    if (v > 255 || (i < 3 && *s++ != '.'))
+      return;
+    tmp[i] = v;
+  }
+  memcpy(out, tmp, 4);
+}
+
+const char *tp_format_rate(uint32_t bytes_per_s, char *buf, size_t len) {
+  static const char *const UNITS[] = {"B/s", "KB/s", "MB/s", "GB/s"};
+  uint32_t v = bytes_per_s, rem = 0;
+  int unit = 0;
+  while (v >= 1000 && unit < 3) {
+    rem = v % 1000;
+    v /= 1000;
+    unit++;
+  }
+  if (unit == 0 || v >= 100)
+    snprintf(buf, len, "%lu %s", (unsigned long)v, UNITS[unit]);
+  else
+    snprintf(buf, len, "%lu.%lu %s", (unsigned long)v,
+             (unsigned long)(rem / 100), UNITS[unit]);
+  return buf;
+}
+
+// =============================================
+// COMMANDS
+// =============================================
+size_t tp_encode_frame(uint8_t type, const uint8_t *payload, size_t len,
+                       uint8_t *out) {
+  uint8_t frame[TP_MAX_FRAME];
+  frame[0] = TP_VERSION;
+  frame[1] = type;
+  memcpy(frame + 2, payload, len);
+  uint16_t crc = tp_crc16(frame, len + 2);
+  frame[len + 2] = crc & 0xFF;
+  frame[len + 3] = crc >> 8;
+  out[0] = 0x00;
+  size_t n = tp_cobs_encode(frame, len + 4, out + 1);
+  out[n + 1] = 0x00;
+  return n + 2;
+}
+
+static void wr16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void wr32(uint8_t *p, uint32_t v) {
+  wr16(p, v & 0xFFFF);
+  wr16(p + 2, v >> 16);
+}
+
+size_t tp_encode_command(const tp_action &action, bool binary, uint32_t tap,
+                         uint8_t *out) {
+  if (!binary)
+    return snprintf((char *)out, TP_COMMAND_MAX,
+                    "{\"action\":\"%s\",\"t\":%lu}\n", action.name,
+                    (unsigned long)tap);
+  uint8_t payload[5] = {action.op};
+  wr32(payload + 1, tap);
+  return tp_encode_frame(TP_MSG_COMMAND, payload, sizeof(payload), out);
+}
+
+// =============================================
+// LATENCY TRACE
+// =============================================
+size_t tp_encode_ack(const tp_trace &trace, uint32_t done,
+                     tp_ack_status status, uint8_t *out) {
+  uint8_t payload[TP_ACK_SIZE];
+  wr16(payload, trace.seq);
+  wr32(payload + 2, trace.sent);
+  wr32(payload + 6, trace.rx);
+  wr32(payload + 10, done);
+  payload[14] = status;
+  return tp_encode_frame(TP_MSG_ACK, payload, sizeof(payload), out);
+}
+
+bool TpTracer::stamp(const uint8_t *p, size_t len) {
+  if (len < TP_STAMP_SIZE)
+    return false;
+  pending_.seq = rd16(p);
+  pending_.sent = rd32(p + 2);
+  stamped_ = true;
+  return true;
+}
+
+bool TpTracer::take(uint32_t now_us, tp_trace &trace) {
+  if (!stamped_)
+    return false;
+  stamped_ = false;
+  trace = pending_;
+  trace.rx = now_us;
+  return true;
+}
+
+// =============================================
+// LINK SPEED
+// =============================================
+// Same rates as TP_BAUD_RATES_JSON
+static const uint32_t BAUD_RATES[] = {2000000, 921600, 460800, 230400};
+
+bool tp_baud_supported(uint32_t rate) {
+  for (uint32_t r : BAUD_RATES)
+    if (r == rate)
+      return true;
+  return rate == TP_BAUD_DEFAULT;
+}
+
+bool TpLink::offer(uint32_t rate, uint32_t now_ms, uint32_t dropped) {
+  if (!tp_baud_supported(rate))
+    return false;
+  baud_ = rate;
+  trial_ = rate != TP_BAUD_DEFAULT;
+  probes_ = 0;
+  trialStart_ = windowStart_ = now_ms;
+  windowDropped_ = dropped;
+  return true;
+}
+
+void TpLink::probe() {
+  if (trial_ && ++probes_ >= TP_BAUD_PROBES)
+    trial_ = false;
+}
+
+void TpLink::woke(uint32_t now_ms, uint32_t dropped) {
+  grace_ = true;
+  graceStart_ = now_ms;
+  graceDropped_ = dropped;
+}
+
+uint32_t TpLink::poll(uint32_t now_ms, uint32_t dropped) {
+  if (grace_) {
+    uint32_t lost = dropped - graceDropped_;
+    wakeDrops_ += lost;
+    windowDropped_ += lost; // as if they never happened
+    graceDropped_ = dropped;
+    grace_ = now_ms - graceStart_ < TP_BAUD_WAKE_GRACE_MS;
+  }
+  if (baud_ == TP_BAUD_DEFAULT)
+    return 0;
+  if (trial_ && now_ms - trialStart_ >= TP_BAUD_TRIAL_MS)
+    return fallBack();
+  if (now_ms - windowStart_ >= TP_BAUD_ERROR_WINDOW_MS) {
+    windowStart_ = now_ms;
+    windowDropped_ = dropped;
+  }
+  if (dropped - windowDropped_ >= TP_BAUD_MAX_ERRORS)
+    return fallBack();
+  return 0;
+}
+
+uint32_t TpLink::fallBack() {
+  baud_ = TP_BAUD_DEFAULT;
+  trial_ = false;
+  fallbacks_++;
+  return TP_BAUD_DEFAULT;
+}
+
+// =============================================
+// COMMAND JOBS
+// =============================================
+static const char *const JOB_STATE_NAMES[] = {"accepted", "running", "done",
+                                              "duplicate", "rejected"};
+
+bool tp_job_state_parse(const char *name, tp_job_state &out) {
+  if (!name)
+    return false;
+  for (uint8_t i = 0; i < sizeof(JOB_STATE_NAMES) / sizeof(*JOB_STATE_NAMES);
+       i++) {
+    if (strcmp(name, JOB_STATE_NAMES[i]) == 0) {
+      out = (tp_job_state)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *tp_job_text(const tp_job &job, char *buf, size_t len) {
+  switch (job.state) {
+  case TP_JOB_ACCEPTED:
+    snprintf(buf, len, "Queued");
+    break;
+  case TP_JOB_RUNNING:
+    snprintf(buf, len, "Running...");
+    break;
+  case TP_JOB_DUPLICATE:
+    snprintf(buf, len, "Already running");
+    break;
+  case TP_JOB_REJECTED:
+    snprintf(buf, len, "Unknown command");
+    break;
+  case TP_JOB_DONE:
+    if (job.rc == 0)
+      snprintf(buf, len, "Done (%lu.%lu s)", (unsigned long)(job.ms / 1000),
+               (unsigned long)(job.ms % 1000 / 100));
+    else if (job.rc == -1)
+      snprintf(buf, len, "Timed out");
+    else
+      snprintf(buf, len, "Failed (rc %d)", job.rc);
+    break;
+  }
+  return buf;
+}
+
+// =============================================
+// FRAMER
+// =============================================
+tp_frame_kind TpFramer::push(uint8_t c) {
+  bool json = len_ > 0 && buf_[0] == '{';
+
+  if (overflow_) {
+    // Swallow the rest of an oversized/garbage frame
+    if (c == 0x00 || c == '\n') {
+      overflow_ = false;
+      len_ = 0;
+      dropped_++;
+    }
+    return TP_FRAME_NONE;
+  }
+
+  if (c == 0x00) {
+    if (len_ == 0)
+      return TP_FRAME_NONE;
+    if (json) { // NUL inside a JSON line: corrupted
+      len_ = 0;
+      dropped_++;
+      return TP_FRAME_NONE;
+    }
+    return finishBinary();
+  }
+
+  if (json && c == '\n') {
+    buf_[len_] = '\0';
+    len_ = 0;
+    return TP_FRAME_JSON;
+  }
+  if (json && c == '\r')
+    return TP_FRAME_NONE;
+
+  // A COBS frame is at most TP_MAX_FRAME + 1 bytes
+  size_t limit = (len_ == 0 ? c == '{' : json) ? TP_MAX_LINE : TP_MAX_FRAME + 1;
+  if (len_ >= limit) {
+    overflow_ = true;
+    return TP_FRAME_NONE;
+  }
+  buf_[len_++] = c;
+  return TP_FRAME_NONE;
+}
+
+tp_frame_kind TpFramer::finishBinary() {
+  size_t n = tp_cobs_decode(buf_, len_);
+  len_ = 0;
+  if (n < 4 || n > TP_MAX_FRAME || buf_[0] != TP_VERSION ||
+      tp_crc16(buf_, n - 2) != rd16(buf_ + n - 2)) {
+    dropped_++;
+    return TP_FRAME_NONE;
+  }
+  frameLen_ = n;
+  return TP_FRAME_BINARY;
+}
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================
+// TRAVEL SERVER SERIAL PROTOCOL
+// =============================================
+// Two kinds of frames share the bridge -> display link:
+//
+//   JSON   '{' ... '\n'           legacy/fallback, one object per line
+//   BINARY COBS(frame) 0x00       negotiated with a hello exchange
+//
+// A binary frame (before COBS) is:
+//
+//   [version u8][type u8][payload ...][crc16 lo][crc16 hi]
+//
+// The CRC is CRC-16/CCITT-FALSE over version, type and payload. All
+// multi-byte payload fields are little-endian. Keep in sync with
+// LCD/bridge/protocol.py.
+
+#define TP_VERSION 1
+
+// Raw frame limit. Keeping it below 122 bytes guarantees the leading COBS
+// code byte is never '{', so the framer can tell both kinds apart from the
+// first byte alone.
+#define TP_MAX_FRAME 120
+
+// Longest JSON line accepted from the bridge.
+#define TP_MAX_LINE 512
+
+enum tp_msg_type : uint8_t {
+  TP_MSG_TELEMETRY = 0x01,       // full struct (keyframe)
+  TP_MSG_TELEMETRY_DELTA = 0x02, // [mask u16][fields whose bit is set]
+  TP_MSG_STAMP = 0x03,           // stamps the next telemetry frame (TRACE)
+  TP_MSG_COMMAND = 0x10,         // display -> bridge: [opcode u8][tap u32]
+  TP_MSG_ACK = 0x11,             // display -> bridge: telemetry shown (TRACE)
+  TP_MSG_PROBE = 0x20,           // link speed check, echoed by the display
+};
+
+// Interface slots of the fixed telemetry struct, in wire order.
+enum tp_iface : uint8_t {
+  TP_IF_WLAN0 = 0,
+  TP_IF_WLAN1,
+  TP_IF_ETH0,
+  TP_IF_USB0,
+  TP_IF_COUNT
+};
+
+extern const char *const tp_if_names[TP_IF_COUNT];
+
+// Throughput of one interface role, summed by the bridge over its
+// interfaces (uplink: wlan1/eth0/usb0, hotspot: wlan0)
+struct tp_traffic {
+  uint32_t rx;  // bytes/s
+  uint32_t tx;  // bytes/s
+  float drops;  // dropped + errored packets/s
+};
+
+// Decoded telemetry, in display units
+struct tp_telemetry {
+  float cpu;          // %
+  float ram_percent;  // %
+  uint16_t ram_used;  // MB
+  uint16_t ram_total; // MB
+  float disk_percent; // %
+  uint16_t disk_used; // GB
+  uint16_t disk_total;
+  float temp;      // degrees C
+  uint32_t uptime; // seconds
+  uint8_t ip[TP_IF_COUNT][4]; // 0.0.0.0 = interface down
+  tp_traffic uplink;
+  tp_traffic hotspot;
+};
+
+// Wire size of a TP_MSG_TELEMETRY payload. Bridges from before the traffic
+// fields send only the first TP_TELEMETRY_MIN_SIZE bytes.
+#define TP_TELEMETRY_SIZE 56
+#define TP_TELEMETRY_MIN_SIZE 36
+
+#define TP_FIELD_COUNT 15
+
+// Field bits, in wire order. Used as the delta mask on the wire and as the
+// "what changed" mask handed back to the UI.
+enum tp_field : uint16_t {
+  TP_F_CPU = 1 << 0,
+  TP_F_RAM_PCT = 1 << 1,
+  TP_F_RAM_USED = 1 << 2,
+  TP_F_RAM_TOTAL = 1 << 3,
+  TP_F_DISK_PCT = 1 << 4,
+  TP_F_DISK_USED = 1 << 5,
+  TP_F_DISK_TOTAL = 1 << 6,
+  TP_F_TEMP = 1 << 7,
+  TP_F_UPTIME = 1 << 8,
+  TP_F_IP0 = 1 << 9, // TP_F_IP0 << tp_iface
+  TP_F_UPLINK = 1 << 13,
+  TP_F_HOTSPOT = 1 << 14,
+  TP_F_ALL = (1 << 15) - 1, // TP_FIELD_COUNT bits
+};
+
+#define TP_F_RAM (TP_F_RAM_PCT | TP_F_RAM_USED | TP_F_RAM_TOTAL)
+#define TP_F_DISK (TP_F_DISK_PCT | TP_F_DISK_USED | TP_F_DISK_TOTAL)
+#define TP_F_NET (TP_F_IP0 * ((1 << TP_IF_COUNT) - 1))
+#define TP_F_TRAFFIC (TP_F_UPLINK | TP_F_HOTSPOT)
+
+// Store value into field, flagging bit in changed only if it differs
+template <typename T>
+inline void tp_set(T &field, T value, uint16_t bit, uint16_t &changed) {
+  if (field != value) {
+    field = value;
+    changed |= bit;
+  }
+}
+
+// =============================================
+// COMMANDS
+// =============================================
+// The actions themselves are generated from LCD/actions/actions.json into
+// TravelActions.h (tp_actions[]) and LCD/bridge/actions.py.
+
+struct tp_action {
+  uint8_t op;        // stable opcode, sent in TP_MSG_COMMAND frames
+  const char *name;  // job name the bridge reports progress under
+  const char *label; // button text
+  uint32_t rgb;      // button color, 0xRRGGBB
+  uint16_t rgb565;   // same, for TFT_eSPI
+  bool confirm;      // ask before sending
+};
+
+// A bridge whose hello carries "cmd":1 takes commands as binary frames:
+// 0x00, COBS(TP_MSG_COMMAND frame), 0x00. The leading NUL separates the
+// frame from any text line the firmware printed before it. Older bridges
+// get the {"action":"<name>","t":<tap>} line instead. Both carry tap, the
+// micros() of the touch that triggered the command (see LATENCY TRACE);
+// bridges that predate it only read the opcode / action.
+#define TP_COMMAND_FRAME_SIZE TP_FRAME_OUT(5)
+#define TP_COMMAND_MAX (TP_ACTION_LEN + 29) // longest JSON form
+
+// Write the command for action into out (TP_COMMAND_MAX bytes, no heap).
+// Returns its length.
+size_t tp_encode_command(const tp_action &action, bool binary, uint32_t tap,
+                         uint8_t *out);
+
+// Display -> bridge frame: 0x00, COBS(version, type, payload, crc), 0x00.
+// out needs TP_FRAME_OUT(len) bytes. Returns the length written.
+#define TP_FRAME_OUT(len) ((len) + 7)
+size_t tp_encode_frame(uint8_t type, const uint8_t *payload, size_t len,
+                       uint8_t *out);
+
+// =============================================
+// LINK SPEED
+// =============================================
+// Both ends start at TP_BAUD_DEFAULT. The display lists the rates it can
+// run in its hello ("baud":TP_BAUD_RATES_JSON); the bridge offers one:
+//
+//   bridge  -> {"baud":921600}
+//   display -> {"baud":921600}   ({"baud":0} if it can't), then switches
+//   bridge  -> TP_MSG_PROBE frames at the new rate, each echoed back
+//
+// TP_BAUD_PROBES intact probes commit the rate. Without them within
+// TP_BAUD_TRIAL_MS, or after TP_BAUD_MAX_ERRORS bad frames within
+// TP_BAUD_ERROR_WINDOW_MS at a negotiated rate, the display drops back to
+// TP_BAUD_DEFAULT and says hello again. A display that light-sleeps loses
+// the start of the frame whose bytes wake its UART; drops within
+// TP_BAUD_WAKE_GRACE_MS of such a wakeup are not counted. Keep in sync
+// with LCD/bridge/linkspeed.py.
+#define TP_BAUD_DEFAULT 115200
+#define TP_BAUD_RATES_JSON "[2000000,921600,460800,230400]"
+#define TP_BAUD_PROBES 4
+#define TP_BAUD_TRIAL_MS 1500
+#define TP_BAUD_ERROR_WINDOW_MS 30000
+#define TP_BAUD_MAX_ERRORS 3
+#define TP_BAUD_WAKE_GRACE_MS 100
+#define TP_PROBE_MAX 48 // payload bytes
+
+bool tp_baud_supported(uint32_t rate);
+
+// Which rate the display side of the link should be at. Owned by whoever
+// owns the UART; the caller does the switching.
+class TpLink {
+public:
+  TpLink()
+      : baud_(TP_BAUD_DEFAULT), trial_(false), grace_(false), probes_(0),
+        trialStart_(0), windowStart_(0), windowDropped_(0), graceStart_(0),
+        graceDropped_(0), wakeDrops_(0), fallbacks_(0) {}
+
+  uint32_t baud() const { return baud_; }
+  // Waiting for probes: poll() has a deadline to enforce
+  bool trial() const { return trial_; }
+  // Times a negotiated rate was abandoned
+  uint16_t fallbacks() const { return fallbacks_; }
+  // Framer drops discounted as wakeup losses (see woke())
+  uint32_t wakeDrops() const { return wakeDrops_; }
+
+  // The bridge offered rate. True if supported: acknowledge it at the
+  // current rate, then switch the UART to it.
+  bool offer(uint32_t rate, uint32_t now_ms, uint32_t dropped);
+
+  // An intact TP_MSG_PROBE frame arrived (and is being echoed)
+  void probe();
+
+  // The UART just came out of light sleep on received bytes: the frame
+  // they belonged to is cut short. Drops until TP_BAUD_WAKE_GRACE_MS from
+  // now are that loss, not link errors.
+  void woke(uint32_t now_ms, uint32_t dropped);
+
+  // Call regularly with the framer's drop counter. Returns TP_BAUD_DEFAULT
+  // when the UART has to go back to it (then say hello again), else 0.
+  uint32_t poll(uint32_t now_ms, uint32_t dropped);
+
+private:
+  uint32_t fallBack();
+
+  uint32_t baud_;
+  bool trial_; // switched, not all probes seen yet
+  bool grace_;  // woke() recently
+  uint8_t probes_;
+  uint32_t trialStart_;
+  uint32_t windowStart_;   // error window
+  uint32_t windowDropped_; // framer drops when it started, plus excused ones
+  uint32_t graceStart_;
+  uint32_t graceDropped_; // framer drops accounted for during the grace
+  uint32_t wakeDrops_;
+  uint16_t fallbacks_;
+};
+
+// =============================================
+// LATENCY TRACE
+// =============================================
+// A bridge whose hello carries "trace":1 sends a TP_MSG_STAMP frame right
+// before every telemetry frame:
+//
+//   [seq u16][sent u32]    sent: bridge monotonic clock, us, wrapping
+//
+// Once that telemetry is on the panel, the display answers with
+//
+//   TP_MSG_ACK [seq u16][sent u32][rx u32][done u32][status u8]
+//
+// rx and done are the display's micros() when the telemetry frame was
+// decoded and when its update finished going out to the panel. From these
+// the bridge gets telemetry-to-panel latency, the offset between the two
+// clocks (which dates the tap of a command) and lost or reordered frames.
+// Keep in sync with LCD/bridge/latency.py.
+enum tp_ack_status : uint8_t {
+  TP_ACK_DRAWN = 0,  // done: end of the panel update that shows it
+  TP_ACK_UNCHANGED,  // nothing visible changed, done = rx
+  TP_ACK_SUPERSEDED, // merged into a later update before it was drawn
+};
+
+#define TP_STAMP_SIZE 6
+#define TP_ACK_SIZE 15
+#define TP_ACK_FRAME_SIZE TP_FRAME_OUT(TP_ACK_SIZE)
+
+struct tp_trace {
+  uint16_t seq;
+  uint32_t sent; // bridge clock
+  uint32_t rx;   // display clock
+};
+
+// Write the TP_MSG_ACK frame for trace into out (TP_ACK_FRAME_SIZE bytes)
+size_t tp_encode_ack(const tp_trace &trace, uint32_t done,
+                     tp_ack_status status, uint8_t *out);
+
+// Pairs each stamp with the telemetry frame that follows it. A stamp whose
+// telemetry never arrives is replaced by the next one.
+class TpTracer {
+public:
+  TpTracer() : stamped_(false) {}
+
+  // A TP_MSG_STAMP frame arrived; false if its payload is malformed
+  bool stamp(const uint8_t *payload, size_t len);
+
+  // Telemetry was decoded at now_us. True if it was stamped; trace then
+  // holds the stamp, with rx = now_us.
+  bool take(uint32_t now_us, tp_trace &trace);
+
+private:
+  tp_trace pending_;
+  bool stamped_;
+};
+
+// =============================================
+// COMMAND JOBS
+// =============================================
+// The bridge runs each {"action":...} the display sends as a job and
+// reports its progress as a JSON line:
+//   {"job":{"id":N,"action":"...","state":"...","rc":N,"ms":N}}
+// rc and ms are only present when the state is "done".
+
+enum tp_job_state : uint8_t {
+  TP_JOB_ACCEPTED = 0, // queued
+  TP_JOB_RUNNING,
+  TP_JOB_DONE,      // rc / ms valid
+  TP_JOB_DUPLICATE, // same action already in flight; updates follow for it
+  TP_JOB_REJECTED,  // bridge doesn't know the action
+};
+
+#define TP_ACTION_LEN 16
+
+struct tp_job {
+  uint16_t id; // 0 for rejected actions
+  tp_job_state state;
+  int16_t rc;  // exit status, -1 timeout, -2 could not start
+  uint32_t ms; // run time
+  char action[TP_ACTION_LEN];
+};
+
+bool tp_job_state_parse(const char *name, tp_job_state &out);
+
+// No further updates will come for this job
+inline bool tp_job_finished(const tp_job &job) {
+  return job.state == TP_JOB_DONE || job.state == TP_JOB_REJECTED;
+}
+
+// One-line status for the UI ("Queued", "Running...", "Done (2.5 s)",
+// "Failed (rc 1)", ...). Returns buf.
+const char *tp_job_text(const tp_job &job, char *buf, size_t len);
+
+enum tp_frame_kind : uint8_t {
+  TP_FRAME_NONE = 0, // nothing complete yet (or frame dropped)
+  TP_FRAME_JSON,     // line() holds a NUL-terminated JSON object
+  TP_FRAME_BINARY,   // type()/payload()/payloadLength() are valid
+};
+
+uint16_t tp_crc16(const uint8_t *data, size_t len);
+
+// COBS encode len (< 254) bytes into out (len + 1 bytes). Returns len + 1.
+size_t tp_cobs_encode(const uint8_t *data, size_t len, uint8_t *out);
+
+// In-place COBS decode. Returns decoded length, or 0 on a malformed block.
+size_t tp_cobs_decode(uint8_t *buf, size_t len);
+
+// Merge a TP_MSG_TELEMETRY or TP_MSG_TELEMETRY_DELTA payload into model.
+// changed receives the bits of fields whose value actually differs, so
+// callers can skip widgets that don't need a redraw.
+bool tp_decode_telemetry(uint8_t type, const uint8_t *payload, size_t len,
+                         tp_telemetry &model, uint16_t &changed);
+
+bool tp_ip_valid(const uint8_t ip[4]);
+
+// Parse dotted IPv4 ("N/A", NULL etc. give 0.0.0.0)
+void tp_parse_ip(const char *s, uint8_t out[4]);
+
+// Human-readable rate: "512 B/s", "12.3 KB/s", "1.5 MB/s". Returns buf.
+const char *tp_format_rate(uint32_t bytes_per_s, char *buf, size_t len);
+
+// Splits the incoming byte stream into JSON lines and binary frames.
+// Fed one byte at a time; uses a single static-size buffer, no heap.
+class TpFramer {
+public:
+  TpFramer() : len_(0), overflow_(false), dropped_(0) {}
+
+  tp_frame_kind push(uint8_t c);
+
+  const char *line() const { return (const char *)buf_; }
+  uint8_t type() const { return buf_[1]; }
+  const uint8_t *payload() const { return buf_ + 2; }
+  size_t payloadLength() const { return frameLen_ - 4; }
+
+  // Frames discarded for bad CRC, version, COBS or length
+  uint32_t dropped() const { return dropped_; }
+
+private:
+  tp_frame_kind finishBinary();
+
+  uint8_t buf_[TP_MAX_LINE + 1];
+  size_t len_;
+  size_t frameLen_;
+  bool overflow_;
+  uint32_t dropped_;
+};
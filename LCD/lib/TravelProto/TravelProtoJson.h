@@ -0,0 +1,90 @@
+#pragma once
+
+// JSON fallback decoding, shared by the firmwares that link ArduinoJson.
+// Kept out of TravelProto.h so the core protocol has no dependencies.
+
+#include <ArduinoJson.h>
+#include <string.h>
+
+#include "TravelProto.h"
+
+inline void tp_merge_traffic(JsonObjectConst o, tp_traffic &t, uint16_t bit,
+                             uint16_t &changed) {
+  tp_traffic v = {o["rx"] | 0u, o["tx"] | 0u, o["drops"] | 0.0f};
+  if (v.rx != t.rx || v.tx != t.tx || v.drops != t.drops) {
+    t = v;
+    changed |= bit;
+  }
+}
+
+// Merge a (possibly partial) JSON telemetry object into model. Keys that
+// are absent leave the model untouched; "ram", "disk", "net" and "traffic"
+// are always sent whole. Returns false if the object holds no telemetry.
+inline bool tp_merge_json(JsonVariantConst doc, tp_telemetry &model,
+                          uint16_t &changed) {
+  changed = 0;
+  bool any = false;
+
+  if (doc["cpu"].is<float>()) {
+    tp_set(model.cpu, doc["cpu"].as<float>(), TP_F_CPU, changed);
+    any = true;
+  }
+  JsonObjectConst ram = doc["ram"];
+  if (ram) {
+    tp_set(model.ram_percent, ram["percent"] | 0.0f, TP_F_RAM_PCT, changed);
+    tp_set(model.ram_used, (uint16_t)(ram["used"] | 0), TP_F_RAM_USED, changed);
+    tp_set(model.ram_total, (uint16_t)(ram["total"] | 0), TP_F_RAM_TOTAL,
+           changed);
+    any = true;
+  }
+  JsonObjectConst disk = doc["disk"];
+  if (disk) {
+    tp_set(model.disk_percent, disk["percent"] | 0.0f, TP_F_DISK_PCT, changed);
+    tp_set(model.disk_used, (uint16_t)(disk["used"] | 0), TP_F_DISK_USED,
+           changed);
+    tp_set(model.disk_total, (uint16_t)(disk["total"] | 0), TP_F_DISK_TOTAL,
+           changed);
+    any = true;
+  }
+  if (doc["temp"].is<float>()) {
+    tp_set(model.temp, doc["temp"].as<float>(), TP_F_TEMP, changed);
+    any = true;
+  }
+  if (doc["uptime"].is<uint32_t>()) {
+    tp_set(model.uptime, doc["uptime"].as<uint32_t>(), TP_F_UPTIME, changed);
+    any = true;
+  }
+  JsonObjectConst net = doc["net"];
+  if (net) {
+    for (int i = 0; i < TP_IF_COUNT; i++) {
+      uint8_t ip[4];
+      tp_parse_ip(net[tp_if_names[i]].as<const char *>(), ip);
+      if (memcmp(model.ip[i], ip, 4) != 0) {
+        memcpy(model.ip[i], ip, 4);
+        changed |= TP_F_IP0 << i;
+      }
+    }
+    any = true;
+  }
+  JsonObjectConst traffic = doc["traffic"];
+  if (traffic) {
+    tp_merge_traffic(traffic["uplink"], model.uplink, TP_F_UPLINK, changed);
+    tp_merge_traffic(traffic["hotspot"], model.hotspot, TP_F_HOTSPOT, changed);
+    any = true;
+  }
+  return any;
+}
+
+// Parse the body of a {"job":{...}} progress message. False if it is not
+// one or the state is unknown.
+inline bool tp_parse_job(JsonVariantConst doc, tp_job &job) {
+  JsonObjectConst j = doc["job"];
+  if (!j || !tp_job_state_parse(j["state"].as<const char *>(), job.state))
+    return false;
+  job.id = j["id"] | 0;
+  job.rc = j["rc"] | 0;
+  job.ms = j["ms"] | 0;
+  strncpy(job.action, j["action"] | "", sizeof(job.action) - 1);
+  job.action[sizeof(job.action) - 1] = '\0';
+  return true;
+}
@@ -0,0 +1,113 @@
+#include "Xpt2046.h"
+
+// Control bytes: start bit, channel, 12-bit differential mode, PD = 01
+// (ADC on, PENIRQ off) during the burst
+#define XPT_CMD_X 0xD1
+#define XPT_CMD_Y 0x91
+#define XPT_CMD_Z1 0xB1
+#define XPT_CMD_Z2 0xC1
+#define XPT_CMD_POWER_DOWN 0x80 // PD = 00: powered down, PENIRQ on
+
+// Z1, Z2, samples x (X, Y), power down
+#define XPT_MAX_CMDS (3 + 2 * XPT_MAX_SAMPLES)
+
+xpt_calibration xpt_calibration_swapped(uint16_t rx_min, uint16_t rx_max,
+                                        uint16_t ry_min, uint16_t ry_max,
+                                        int16_t w, int16_t h) {
+  float sx = (float)w / (ry_max - ry_min);
+  float sy = (float)h / (rx_max - rx_min);
+  return {0, sx, -ry_min * sx, sy, 0, -rx_min * sy, w, h};
+}
+
+Xpt2046::Xpt2046(SPIClass &spi, uint8_t cs, uint8_t irq)
+    : spi_(spi), cs_(cs), irq_(irq), samples_(3),
+      cal_(xpt_calibration_swapped(0, 4095, 0, 4095, 320, 240)) {}
+
+void Xpt2046::begin(int8_t sck, int8_t miso, int8_t mosi) {
+  pinMode(cs_, OUTPUT);
+  digitalWrite(cs_, HIGH);
+  pinMode(irq_, INPUT);
+  spi_.begin(sck, miso, mosi, cs_);
+  powerDown();
+}
+
+void Xpt2046::setOversampling(uint8_t samples) {
+  samples_ = constrain(samples, 1, XPT_MAX_SAMPLES);
+}
+
+static uint16_t median(uint16_t *v, uint8_t n) {
+  for (uint8_t i = 1; i < n; i++) {
+    uint16_t t = v[i];
+    uint8_t j = i;
+    for (; j > 0 && v[j - 1] > t; j--)
+      v[j] = v[j - 1];
+    v[j] = t;
+  }
+  return v[n / 2];
+}
+
+bool Xpt2046::readRaw(xpt_raw &raw) {
+  // Command k goes out at byte 2k; its result is bytes 2k+1 (hi) and
+  // 2k+2 (lo), the latter shifted in while command k+1 is sent
+  uint8_t buf[2 * XPT_MAX_CMDS + 1];
+  uint8_t n = 0;
+  buf[2 * n++] = XPT_CMD_Z1;
+  buf[2 * n++] = XPT_CMD_Z2;
+  for (uint8_t i = 0; i < samples_; i++) {
+    buf[2 * n++] = XPT_CMD_X;
+    buf[2 * n++] = XPT_CMD_Y;
+  }
+  buf[2 * n++] = XPT_CMD_POWER_DOWN;
+  size_t len = 2 * n + 1;
+  for (uint8_t k = 0; k < n; k++)
+    buf[2 * k + 1] = 0;
+  buf[len - 1] = 0;
+
+  spi_.beginTransaction(SPISettings(XPT_SPI_HZ, MSBFIRST, SPI_MODE0));
+  digitalWrite(cs_, LOW);
+  spi_.transfer(buf, len);
+  digitalWrite(cs_, HIGH);
+  spi_.endTransaction();
+
+  auto result = [&](uint8_t k) -> uint16_t {
+    return ((buf[2 * k + 1] << 8) | buf[2 * k + 2]) >> 3;
+  };
+
+  int z = result(0) + 4095 - result(1);
+  if (z <= XPT_Z_THRESHOLD)
+    return false;
+
+  uint16_t xs[XPT_MAX_SAMPLES], ys[XPT_MAX_SAMPLES];
+  for (uint8_t i = 0; i < samples_; i++) {
+    xs[i] = result(2 + 2 * i);
+    ys[i] = result(3 + 2 * i);
+  }
+  raw.x = median(xs, samples_);
+  raw.y = median(ys, samples_);
+  raw.z = z;
+  return true;
+}
+
+void Xpt2046::toScreen(const xpt_raw &raw, int &x, int &y) const {
+  x = (int)(cal_.a * raw.x + cal_.b * raw.y + cal_.c);
+  y = (int)(cal_.d * raw.x + cal_.e * raw.y + cal_.f);
+  x = constrain(x, 0, cal_.width - 1);
+  y = constrain(y, 0, cal_.height - 1);
+}
+
+bool Xpt2046::read(int &x, int &y) {
+  xpt_raw raw;
+  if (!readRaw(raw))
+    return false;
+  toScreen(raw, x, y);
+  return true;
+}
+
+void Xpt2046::powerDown() {
+  uint8_t buf[3] = {XPT_CMD_POWER_DOWN, 0, 0};
+  spi_.beginTransaction(SPISettings(XPT_SPI_HZ, MSBFIRST, SPI_MODE0));
+  digitalWrite(cs_, LOW);
+  spi_.transfer(buf, sizeof(buf));
+  digitalWrite(cs_, HIGH);
+  spi_.endTransaction();
+}
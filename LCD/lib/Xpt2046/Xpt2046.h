@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+
+// =============================================
+// XPT2046 RESISTIVE TOUCH CONTROLLER
+// =============================================
+// Reads pressure, X and Y in a single SPI transaction: CS is asserted
+// once and every command byte is sent while the previous conversion's
+// low byte clocks out (16 clocks per conversion). The burst ends with a
+// power-down command, which re-arms PENIRQ. X and Y are sampled N times
+// and the median is used, which rejects the odd spike a single read lets
+// through.
+
+// The chip is rated for a 2.5 MHz DCLK; the board's build flags say so
+#ifdef SPI_TOUCH_FREQUENCY
+#define XPT_SPI_HZ SPI_TOUCH_FREQUENCY
+#else
+#define XPT_SPI_HZ 2500000
+#endif
+
+#define XPT_MAX_SAMPLES 7
+#define XPT_Z_THRESHOLD 400 // z1 + 4095 - z2 above this = pressed
+
+// Raw 12-bit conversions of one burst (X/Y are medians)
+struct xpt_raw {
+  uint16_t x, y;
+  uint16_t z; // pressure, z1 + 4095 - z2
+};
+
+// Affine raw -> screen mapping, clamped to width x height:
+//   sx = a * rx + b * ry + c
+//   sy = d * rx + e * ry + f
+struct xpt_calibration {
+  float a, b, c, d, e, f;
+  int16_t width, height;
+};
+
+// Mapping for a panel whose screen X follows raw Y and screen Y follows
+// raw X (the ESP32-2432S028 in landscape): raw ranges map onto 0..w / 0..h
+xpt_calibration xpt_calibration_swapped(uint16_t rx_min, uint16_t rx_max,
+                                        uint16_t ry_min, uint16_t ry_max,
+                                        int16_t w, int16_t h);
+
+class Xpt2046 {
+public:
+  Xpt2046(SPIClass &spi, uint8_t cs, uint8_t irq);
+
+  // Configures CS/IRQ, starts the bus and powers the chip down
+  void begin(int8_t sck, int8_t miso, int8_t mosi);
+
+  // X/Y samples per read (1..XPT_MAX_SAMPLES, odd values give a true median)
+  void setOversampling(uint8_t samples);
+  void setCalibration(const xpt_calibration &cal) { cal_ = cal; }
+
+  // PENIRQ low: something is touching the panel. Costs no SPI traffic.
+  bool touched() const { return digitalRead(irq_) == LOW; }
+
+  // One burst. False (raw.x/y untouched) if the pressure is too low.
+  bool readRaw(xpt_raw &raw);
+
+  // Raw reading -> screen coordinates through the calibration
+  void toScreen(const xpt_raw &raw, int &x, int &y) const;
+
+  // readRaw() + toScreen()
+  bool read(int &x, int &y);
+
+  // Power down with PENIRQ enabled (also done at the end of every burst)
+  void powerDown();
+
+private:
+  SPIClass &spi_;
+  uint8_t cs_, irq_;
+  uint8_t samples_;
+  xpt_calibration cal_;
+};
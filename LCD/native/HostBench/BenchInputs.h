@@ -0,0 +1,63 @@
+#pragma once
+
+// Bridge -> display inputs shared by both firmwares' benchmarks. The
+// realistic ones are what LCD/bridge/protocol.py produces for a Pi with
+// the hotspot up; regenerate them when the telemetry format changes.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+// Full JSON telemetry line, as json.dumps() writes it
+static const char BENCH_JSON_TELEMETRY[] =
+    "{\"cpu\": 12.5, \"ram\": {\"total\": 3792, \"used\": 1210, \"percent\": "
+    "31.9}, \"disk\": {\"total\": 29, \"used\": 7, \"percent\": 24.1}, "
+    "\"temp\": 51.6, \"net\": {\"wlan0\": \"10.42.0.1\", \"wlan1\": "
+    "\"192.168.1.23\"}, \"traffic\": {\"uplink\": {\"rx\": 182340, \"tx\": "
+    "20411, \"drops\": 0.0}, \"hotspot\": {\"rx\": 20102, \"tx\": 179230, "
+    "\"drops\": 0.5}}, \"uptime\": 86400}";
+
+// The update after BENCH_JSON_TELEMETRY: CPU, RAM, temperature and
+// throughput moved, addresses and disk did not
+static const char BENCH_JSON_TICK[] =
+    "{\"cpu\": 40.0, \"ram\": {\"total\": 3792, \"used\": 1251, \"percent\": "
+    "33.0}, \"disk\": {\"total\": 29, \"used\": 7, \"percent\": 24.1}, "
+    "\"temp\": 52.3, \"net\": {\"wlan0\": \"10.42.0.1\", \"wlan1\": "
+    "\"192.168.1.23\"}, \"traffic\": {\"uplink\": {\"rx\": 1534210, \"tx\": "
+    "88120, \"drops\": 0.0}, \"hotspot\": {\"rx\": 86900, \"tx\": 1520400, "
+    "\"drops\": 1.5}}, \"uptime\": 86402}";
+
+// Valid JSON, every value of the wrong type
+static const char BENCH_JSON_WRONG_TYPES[] =
+    "{\"cpu\": \"high\", \"ram\": [1, 2, 3], \"disk\": null, \"temp\": {}, "
+    "\"net\": {\"wlan0\": 12, \"wlan1\": [\"10.0.0.1\"]}, \"uptime\": -1}";
+
+// Line cut off half way, as after a UART overrun
+inline std::string bench_json_truncated() {
+  return std::string(BENCH_JSON_TELEMETRY, sizeof(BENCH_JSON_TELEMETRY) / 2);
+}
+
+// Telemetry followed by a large unknown array, about len bytes: more than
+// the framer ever hands over, and more than any parse arena holds
+inline std::string bench_json_oversized(size_t len) {
+  std::string s(BENCH_JSON_TELEMETRY, sizeof(BENCH_JSON_TELEMETRY) - 2);
+  s += ", \"pad\": [0";
+  while (s.size() + 4 < len)
+    s += ", 0";
+  s += "]}";
+  return s;
+}
+
+// Wire bytes of the same telemetry as a binary keyframe (COBS + 0x00)
+static const uint8_t BENCH_FRAME_KEYFRAME[] = {
+    0x04, 0x01, 0x01, 0x7D, 0x08, 0x3F, 0x01, 0xBA, 0x04, 0xD0, 0x0E,
+    0xF1, 0x02, 0x07, 0x02, 0x1D, 0x06, 0x04, 0x02, 0x80, 0x51, 0x01,
+    0x03, 0x0A, 0x2A, 0x06, 0x01, 0xC0, 0xA8, 0x01, 0x17, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x04, 0x44, 0xC8, 0x02, 0x03, 0xBB,
+    0x4F, 0x01, 0x01, 0x01, 0x03, 0x86, 0x4E, 0x01, 0x04, 0x1E, 0xBC,
+    0x02, 0x02, 0x05, 0x03, 0x8F, 0x7F, 0x00};
+
+// Delta frame: CPU only, 40.0 %
+static const uint8_t BENCH_FRAME_DELTA[] = {0x04, 0x01, 0x02, 0x01, 0x05,
+                                            0x90, 0x01, 0x4D, 0x71, 0x00};
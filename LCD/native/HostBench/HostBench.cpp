@@ -0,0 +1,101 @@
+#include "HostBench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+  std::string name;
+  uint32_t iters;
+  uint32_t bytes;
+  double min, p50, p90; // ns per call
+};
+
+static std::vector<BenchResult> results;
+static const char *firmwareName = "";
+static const char *outPath = nullptr;
+static const char *filter = nullptr;
+static const char *tag = "";
+static double scale = 1.0;
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--out PATH] [--filter TEXT] [--scale F] [--tag TEXT]\n",
+          argv0);
+}
+
+bool bench_begin(int argc, char **argv, const char *firmware) {
+  firmwareName = firmware;
+  for (int i = 1; i < argc; i++) {
+    bool more = i + 1 < argc;
+    if (!strcmp(argv[i], "--out") && more)
+      outPath = argv[++i];
+    else if (!strcmp(argv[i], "--filter") && more)
+      filter = argv[++i];
+    else if (!strcmp(argv[i], "--scale") && more)
+      scale = strtod(argv[++i], nullptr);
+    else if (!strcmp(argv[i], "--tag") && more)
+      tag = argv[++i];
+    else {
+      usage(argv[0]);
+      return false;
+    }
+  }
+  return scale > 0;
+}
+
+void bench_run(const char *name, uint32_t iters, const std::function<void()> &fn,
+               uint32_t bytes) {
+  if (filter && !strstr(name, filter))
+    return;
+  uint32_t perBatch = std::max<uint32_t>(1, iters * scale / BENCH_BATCHES);
+
+  fn(); // warm-up: first-touch allocations, caches
+
+  std::vector<double> ns;
+  for (int b = 0; b < BENCH_BATCHES; b++) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < perBatch; i++)
+      fn();
+    std::chrono::duration<double, std::nano> took =
+        std::chrono::steady_clock::now() - start;
+    ns.push_back(took.count() / perBatch);
+  }
+  std::sort(ns.begin(), ns.end());
+
+  BenchResult r = {name, perBatch * BENCH_BATCHES, bytes, ns.front(),
+                   ns[ns.size() / 2], ns[ns.size() * 9 / 10]};
+  results.push_back(r);
+  fprintf(stderr, "%-24s %10.0f ns  (min %.0f, p90 %.0f)\n", name, r.p50,
+          r.min, r.p90);
+}
+
+int bench_end() {
+  FILE *f = outPath ? fopen(outPath, "w") : stdout;
+  if (!f) {
+    perror(outPath);
+    return 1;
+  }
+  // Names and tags are plain identifiers; no escaping needed
+  fprintf(f, "{\"firmware\":\"%s\",\"tag\":\"%s\",\"results\":[", firmwareName,
+          tag);
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult &r = results[i];
+    fprintf(f,
+            "%s\n  {\"name\":\"%s\",\"iters\":%u,\"bytes\":%u,"
+            "\"ns\":{\"min\":%.0f,\"p50\":%.0f,\"p90\":%.0f}}",
+            i ? "," : "", r.name.c_str(), r.iters, r.bytes, r.min, r.p50,
+            r.p90);
+  }
+  fprintf(f, "]}\n");
+  if (f != stdout && fclose(f) != 0) {
+    perror(outPath);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// =============================================
+// HOST MICROBENCHMARKS
+// =============================================
+// Timing harness for the `bench` PlatformIO environments (see LCD_SETUP.md).
+// Each case runs its body in BENCH_BATCHES batches, and the per-call
+// times come from the batch means, so clock overhead stays out of
+// sub-microsecond cases. The results are written to stdout (or --out)
+// as one JSON document:
+//
+//   {"firmware":"v1","tag":"3f2c1e0","results":[
+//     {"name":"json/realistic","iters":20000,"bytes":312,
+//      "ns":{"min":4100,"p50":4230,"p90":4410}}, ...]}
+//
+//   --out PATH      write the JSON there instead of stdout
+//   --filter TEXT   only run cases whose name contains TEXT
+//   --scale F       multiply every iteration count (quick runs: 0.1)
+//   --tag TEXT      copied into the output, e.g. the commit being measured
+
+#include <stdint.h>
+
+#include <functional>
+
+#define BENCH_BATCHES 25
+
+// Parse the command line. False (after printing usage) on bad arguments.
+bool bench_begin(int argc, char **argv, const char *firmware);
+
+// Time about iters calls of fn. bytes is the input size per call, reported
+// so parse throughput can be derived (0 = not applicable).
+void bench_run(const char *name, uint32_t iters, const std::function<void()> &fn,
+               uint32_t bytes = 0);
+
+// Write the results. Returns the process exit code.
+int bench_end();
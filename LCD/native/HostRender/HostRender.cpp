@@ -0,0 +1,360 @@
+#include "HostRender.h"
+
+#include <ArduinoJson.h>
+#include <host.h>
+#include <lvgl.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct RenderResult {
+  std::string name;
+  uint32_t areas;
+  uint64_t invPx, px;
+  double min, p50, p90; // us per refresh
+  long diff;            // differing pixels, -1 = no reference
+};
+
+static std::vector<RenderResult> results;
+static const char *firmwareName = "";
+static const char *outPath = nullptr;
+static const char *filter = nullptr;
+static const char *tag = "";
+static const char *pngDir = nullptr;
+static const char *refDir = nullptr;
+static const char *baselinePath = nullptr;
+static long maxDiff = 0;
+static double tolerance = 10;
+static bool failed = false;
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--out PATH] [--filter TEXT] [--tag TEXT] [--png DIR]\n"
+          "          [--ref DIR] [--max-diff N] [--baseline FILE]"
+          " [--tolerance PCT]\n",
+          argv0);
+}
+
+bool render_begin(int argc, char **argv, const char *firmware) {
+  firmwareName = firmware;
+  for (int i = 1; i < argc; i++) {
+    bool more = i + 1 < argc;
+    if (!strcmp(argv[i], "--out") && more)
+      outPath = argv[++i];
+    else if (!strcmp(argv[i], "--filter") && more)
+      filter = argv[++i];
+    else if (!strcmp(argv[i], "--tag") && more)
+      tag = argv[++i];
+    else if (!strcmp(argv[i], "--png") && more)
+      pngDir = argv[++i];
+    else if (!strcmp(argv[i], "--ref") && more)
+      refDir = argv[++i];
+    else if (!strcmp(argv[i], "--max-diff") && more)
+      maxDiff = strtol(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--baseline") && more)
+      baselinePath = argv[++i];
+    else if (!strcmp(argv[i], "--tolerance") && more)
+      tolerance = strtod(argv[++i], nullptr);
+    else {
+      usage(argv[0]);
+      return false;
+    }
+  }
+  return tolerance >= 0;
+}
+
+// =============================================
+// PNG (8-bit RGB, stored deflate blocks)
+// =============================================
+// Uncompressed keeps the writer small and lets the reader handle exactly
+// what the writer produces; any viewer or diff tool reads them as well.
+static uint32_t crc32(const uint8_t *p, size_t len, uint32_t crc = 0) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    for (int i = 0; i < 8; i++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+static void put32(std::vector<uint8_t> &out, uint32_t v) {
+  for (int shift = 24; shift >= 0; shift -= 8)
+    out.push_back(v >> shift);
+}
+
+static uint32_t get32(const uint8_t *p) {
+  return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+static void chunk(std::vector<uint8_t> &out, const char *type,
+                  const std::vector<uint8_t> &data) {
+  put32(out, data.size());
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  put32(out, crc32(&out[start], out.size() - start));
+}
+
+static const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+// Framebuffer as PNG scanlines: filter byte 0, then RGB
+static std::vector<uint8_t> scanlines() {
+  int w = host_fb_width(), h = host_fb_height();
+  const uint16_t *fb = host_framebuffer();
+  std::vector<uint8_t> raw;
+  raw.reserve((size_t)h * (w * 3 + 1));
+  for (int y = 0; y < h; y++) {
+    raw.push_back(0);
+    for (int x = 0; x < w; x++) {
+      uint16_t c = fb[y * w + x];
+      raw.push_back(((c >> 11) & 0x1F) * 255 / 31);
+      raw.push_back(((c >> 5) & 0x3F) * 255 / 63);
+      raw.push_back((c & 0x1F) * 255 / 31);
+    }
+  }
+  return raw;
+}
+
+bool render_write_png(const char *path) {
+  std::vector<uint8_t> raw = scanlines();
+
+  std::vector<uint8_t> z = {0x78, 0x01};
+  uint32_t a = 1, b = 0; // adler32
+  for (size_t pos = 0; pos < raw.size();) {
+    size_t n = std::min<size_t>(raw.size() - pos, 0xFFFF);
+    z.push_back(pos + n == raw.size()); // BFINAL, BTYPE 00
+    z.push_back(n & 0xFF);
+    z.push_back(n >> 8);
+    z.push_back(~n & 0xFF);
+    z.push_back((~n >> 8) & 0xFF);
+    z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+    for (size_t i = pos; i < pos + n; i++) {
+      a = (a + raw[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+    pos += n;
+  }
+  put32(z, b << 16 | a);
+
+  std::vector<uint8_t> ihdr;
+  put32(ihdr, host_fb_width());
+  put32(ihdr, host_fb_height());
+  ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, no interlace
+
+  std::vector<uint8_t> png(PNG_SIGNATURE, PNG_SIGNATURE + 8);
+  chunk(png, "IHDR", ihdr);
+  chunk(png, "IDAT", z);
+  chunk(png, "IEND", {});
+
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+  return fclose(f) == 0 && ok;
+}
+
+// Scanlines of a PNG written by render_write_png (empty if it isn't one,
+// or not the framebuffer's size)
+static std::vector<uint8_t> read_png(const char *path) {
+  std::vector<uint8_t> file, z, raw;
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return raw;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    file.insert(file.end(), buf, buf + n);
+  fclose(f);
+  if (file.size() < 8 || memcmp(file.data(), PNG_SIGNATURE, 8) != 0)
+    return raw;
+
+  for (size_t pos = 8; pos + 12 <= file.size();) {
+    uint32_t len = get32(&file[pos]);
+    if (pos + 12 + len > file.size())
+      return raw;
+    const uint8_t *type = &file[pos + 4], *data = &file[pos + 8];
+    if (!memcmp(type, "IHDR", 4) &&
+        (len < 13 || get32(data) != (uint32_t)host_fb_width() ||
+         get32(data + 4) != (uint32_t)host_fb_height() || data[8] != 8 ||
+         data[9] != 2))
+      return raw;
+    if (!memcmp(type, "IDAT", 4))
+      z.insert(z.end(), data, data + len);
+    pos += 12 + len;
+  }
+
+  for (size_t pos = 2; pos + 5 <= z.size();) {
+    uint8_t hdr = z[pos];
+    size_t len = z[pos + 1] | z[pos + 2] << 8;
+    if ((hdr & 0x06) != 0 || pos + 5 + len > z.size())
+      return std::vector<uint8_t>(); // compressed: not one of ours
+    raw.insert(raw.end(), z.begin() + pos + 5, z.begin() + pos + 5 + len);
+    pos += 5 + len;
+    if (hdr & 1)
+      break;
+  }
+  return raw;
+}
+
+// Pixels that differ from the reference, -1 without a usable one
+static long compare_png(const char *path) {
+  std::vector<uint8_t> ref = read_png(path), cur = scanlines();
+  if (ref.size() != cur.size())
+    return -1;
+  size_t stride = host_fb_width() * 3 + 1;
+  long diff = 0;
+  for (size_t row = 0; row < cur.size(); row += stride) {
+    if (ref[row] != 0)
+      return -1; // filtered rows: not written by render_write_png
+    for (size_t i = row + 1; i < row + stride; i += 3)
+      diff += memcmp(&ref[i], &cur[i], 3) != 0;
+  }
+  return diff;
+}
+
+// =============================================
+// CASES
+// =============================================
+// Layout changes invalidate during the refresh's own layout pass; run it
+// first so they show up in the count
+static void update_layout() {
+  lv_disp_t *disp = lv_disp_get_default();
+  lv_obj_update_layout(disp->act_scr);
+  lv_obj_update_layout(disp->top_layer);
+  lv_obj_update_layout(disp->sys_layer);
+}
+
+void render_case(const char *name, const std::function<void()> &reset,
+                 const std::function<void()> &change) {
+  if (filter && !strstr(name, filter))
+    return;
+  lv_disp_t *disp = lv_disp_get_default();
+  RenderResult r = {name, 0, 0, 0, 0, 0, 0, -1};
+
+  std::vector<double> us;
+  for (int i = 0; i < RENDER_ITERS; i++) {
+    reset();
+    lv_refr_now(NULL);
+
+    change();
+    update_layout();
+    uint32_t areas = disp->inv_p;
+    uint64_t invPx = 0;
+    for (uint32_t a = 0; a < areas; a++)
+      invPx += lv_area_get_size(&disp->inv_areas[a]);
+
+    uint64_t px = host_pixels_pushed();
+    auto start = std::chrono::steady_clock::now();
+    lv_refr_now(NULL);
+    std::chrono::duration<double, std::micro> took =
+        std::chrono::steady_clock::now() - start;
+    us.push_back(took.count());
+
+    // Same every time unless the UI has state the reset misses
+    r.areas = std::max(r.areas, areas);
+    r.invPx = std::max(r.invPx, invPx);
+    r.px = std::max(r.px, host_pixels_pushed() - px);
+
+    if (i == 0) {
+      std::string file = std::string("/") + name + ".png";
+      if (pngDir && !render_write_png((pngDir + file).c_str()))
+        fprintf(stderr, "cannot write %s%s\n", pngDir, file.c_str());
+      if (refDir) {
+        r.diff = compare_png((refDir + file).c_str());
+        if (r.diff < 0 || r.diff > maxDiff) {
+          fprintf(stderr, "%s: %ld pixels differ from %s%s\n", name, r.diff,
+                  refDir, file.c_str());
+          failed = true;
+        }
+      }
+    }
+  }
+  std::sort(us.begin(), us.end());
+  r.min = us.front();
+  r.p50 = us[us.size() / 2];
+  r.p90 = us[us.size() * 9 / 10];
+  results.push_back(r);
+  fprintf(stderr, "%-16s %2u areas %7llu inv px %7llu px %8.0f us\n", name,
+          r.areas, (unsigned long long)r.invPx, (unsigned long long)r.px,
+          r.p50);
+}
+
+// =============================================
+// OUTPUT / BASELINE
+// =============================================
+static void check_baseline() {
+  FILE *f = fopen(baselinePath, "rb");
+  if (!f) {
+    perror(baselinePath);
+    failed = true;
+    return;
+  }
+  std::string text;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    text.append(buf, n);
+  fclose(f);
+
+  JsonDocument doc;
+  if (deserializeJson(doc, text)) {
+    fprintf(stderr, "%s: not a render harness result\n", baselinePath);
+    failed = true;
+    return;
+  }
+  for (const RenderResult &r : results) {
+    for (JsonObject base : doc["results"].as<JsonArray>()) {
+      if (r.name != (base["name"] | ""))
+        continue;
+      const struct {
+        const char *key;
+        uint64_t now;
+      } counts[] = {{"inv_px", r.invPx}, {"px", r.px}};
+      for (const auto &c : counts) {
+        double was = base[c.key] | 0.0;
+        if (c.now > was * (1 + tolerance / 100)) {
+          fprintf(stderr, "%s: %s %llu, baseline %.0f (+%.0f%% allowed)\n",
+                  r.name.c_str(), c.key, (unsigned long long)c.now, was,
+                  tolerance);
+          failed = true;
+        }
+      }
+    }
+  }
+}
+
+int render_end() {
+  FILE *f = outPath ? fopen(outPath, "w") : stdout;
+  if (!f) {
+    perror(outPath);
+    return 1;
+  }
+  // Names and tags are plain identifiers; no escaping needed
+  fprintf(f, "{\"firmware\":\"%s\",\"tag\":\"%s\",\"results\":[", firmwareName,
+          tag);
+  for (size_t i = 0; i < results.size(); i++) {
+    const RenderResult &r = results[i];
+    fprintf(f,
+            "%s\n  {\"name\":\"%s\",\"iters\":%d,\"areas\":%u,\"inv_px\":%llu,"
+            "\"px\":%llu,\"us\":{\"min\":%.0f,\"p50\":%.0f,\"p90\":%.0f},"
+            "\"diff\":%ld}",
+            i ? "," : "", r.name.c_str(), RENDER_ITERS, r.areas,
+            (unsigned long long)r.invPx, (unsigned long long)r.px, r.min,
+            r.p50, r.p90, r.diff);
+  }
+  fprintf(f, "]}\n");
+  if (f != stdout && fclose(f) != 0) {
+    perror(outPath);
+    return 1;
+  }
+  if (baselinePath)
+    check_baseline();
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// =============================================
+// HOST RENDER HARNESS
+// =============================================
+// Frame-cost harness for the `render` PlatformIO environment (see
+// LCD_SETUP.md). Runs a firmware's real LVGL UI against the shim's
+// in-memory panel. Each case puts the UI into a start state (`reset`,
+// not measured), applies one change, then forces a refresh and records
+// what it cost:
+//
+//   areas    invalidated areas LVGL had queued
+//   inv_px   their total size in pixels, before LVGL joins overlaps
+//   px       pixels flushed to the panel
+//   us       lv_refr_now() time, min/p50/p90 over the iterations
+//
+// The counts don't depend on the machine, so they can gate CI; the times
+// are for trends only. The results are written as one JSON document:
+//
+//   {"firmware":"v2","tag":"3f2c1e0","results":[
+//     {"name":"tab_switch","iters":20,"areas":1,"inv_px":76800,
+//      "px":76800,"us":{"min":2100,"p50":2180,"p90":2400},"diff":0}, ...]}
+//
+//   --out PATH        write the JSON there instead of stdout
+//   --filter TEXT     only run cases whose name contains TEXT
+//   --tag TEXT        copied into the output, e.g. the commit being measured
+//   --png DIR         write the screen after each case's change to DIR/<name>.png
+//   --ref DIR         compare it with DIR/<name>.png from an earlier --png run;
+//                     "diff" counts the differing pixels (-1: no reference)
+//   --max-diff N      fail if more than N pixels differ (default 0)
+//   --baseline FILE   fail if a case's inv_px or px grew by more than
+//   --tolerance PCT   PCT percent (default 10) over FILE, an earlier --out
+//
+// The exit code is 1 when a check failed, so CI can run the base and head
+// commits and compare, or keep a baseline and snapshots as artifacts.
+
+#include <stdint.h>
+
+#include <functional>
+
+#define RENDER_ITERS 20
+
+// Parse the command line. False (after printing usage) on bad arguments.
+bool render_begin(int argc, char **argv, const char *firmware);
+
+// Measure change, RENDER_ITERS times (reset and a refresh before each).
+// The state after the first change is the one snapshotted and compared.
+void render_case(const char *name, const std::function<void()> &reset,
+                 const std::function<void()> &change);
+
+// Write the results and run the baseline check. Returns the exit code.
+int render_end();
+
+// The framebuffer as an 8-bit RGB PNG (stored, uncompressed deflate)
+bool render_write_png(const char *path);
@@ -0,0 +1,144 @@
+#pragma once
+
+// =============================================
+// HOST SHIM: Arduino core for the Linux emulator
+// =============================================
+// Just enough of the ESP32 Arduino core (and the FreeRTOS calls the
+// firmwares use) to run them as a Linux process. See host.h for the
+// emulator-only API and HostShims.cpp for the implementation.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define DMA_ATTR
+#define IRAM_ATTR
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define digitalPinToInterrupt(p) (p)
+
+// Only TP_IRQ (pin 36) ever fires: on touch down (FALLING/CHANGE) and
+// touch up (RISING/CHANGE)
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// Chip queries; the host pretends to be a 240 MHz core without a heap
+// budget (heap figures read 0)
+class EspClass {
+public:
+  uint32_t getCycleCount() { return (uint32_t)(micros() * 240UL); }
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMinFreeHeap() { return 0; }
+};
+
+extern EspClass ESP;
+
+// The firmware's entry points, driven by the emulator's main()
+void setup();
+void loop();
+
+// =============================================
+// SERIAL (backed by a pseudo-terminal)
+// =============================================
+class HardwareSerial {
+public:
+  typedef void (*OnReceiveCb)();
+
+  void begin(unsigned long baud);
+  void updateBaudRate(unsigned long baud); // a pty carries any rate
+  void onReceive(OnReceiveCb cb);
+  int available();
+  int read();
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t len);
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  void flush() {}
+  int printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+  size_t println() { return write("\r\n"); }
+
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// =============================================
+// FREERTOS (tasks map onto threads)
+// =============================================
+typedef void *TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define pdPASS 1
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE 1
+#define pdFALSE 0
+#define portYIELD_FROM_ISR() ((void)0)
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void *), const char *name,
+                                   uint32_t stack, void *arg, int prio,
+                                   TaskHandle_t *handle, int core);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t task); // NULL: parks the calling thread
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+// Direct-to-task notifications, used as counting semaphores
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+// Mutexes
+typedef void *SemaphoreHandle_t;
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+// ESP-IDF headers the Arduino core pulls in
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include <esp_sleep.h>
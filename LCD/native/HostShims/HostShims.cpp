@@ -0,0 +1,567 @@
+// =============================================
+// LINUX EMULATOR FOR THE DISPLAY FIRMWARE
+// =============================================
+// Runs a firmware's setup()/loop() as a normal process:
+//
+//   Serial      <-> a pseudo-terminal, symlinked to --pty (the bridge
+//                   opens it like the real /dev/ttyUSB0)
+//   TFT_eSPI    ->  in-memory framebuffer, dumped as PPM with --fb
+//   XPT2046     <-  touches replayed from a --touch script
+//   FreeRTOS    ->  one std::thread per task
+//
+// Log lines on stderr are "[ms] event ..." so runs can be diffed and
+// timed (serial byte counts, touch to TX latency).
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#include "host.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static const auto startTime = std::chrono::steady_clock::now();
+
+#define HOST_LOG(fmt, ...)                                                     \
+  fprintf(stderr, "[%8lu] " fmt "\n", millis(), ##__VA_ARGS__)
+
+// =============================================
+// TIME
+// =============================================
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - startTime)
+      .count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - startTime)
+      .count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// =============================================
+// TOUCH (XPT2046 on the touch SPI bus)
+// =============================================
+#define HOST_TP_IRQ 36 // board pin, active low while pressed
+
+static std::atomic<bool> touchDown{false};
+static std::atomic<int> touchX{0}, touchY{0};
+static void (*touchIsr)() = nullptr;
+static int touchIsrMode = 0;
+
+static void hostWake(esp_sleep_wakeup_cause_t cause);
+
+void host_touch_set(bool pressed, int x, int y) {
+  touchX = x;
+  touchY = y;
+  if (pressed == touchDown)
+    return;
+  HOST_LOG("touch %s %d %d", pressed ? "down" : "up", x, y);
+  touchDown = pressed;
+  // PENIRQ goes low on press, high on release
+  if (touchIsr && (touchIsrMode == CHANGE ||
+                   touchIsrMode == (pressed ? FALLING : RISING)))
+    touchIsr();
+  if (pressed)
+    hostWake(ESP_SLEEP_WAKEUP_GPIO);
+}
+
+// 12-bit conversion for a channel, inverse of the firmware's mapping:
+// screen x comes from the Y plate (0x91), screen y from the X plate (0xD1)
+static uint16_t touchConvert(uint8_t cmd) {
+  bool down = touchDown;
+  switch (cmd & 0x70) {
+  case 0x30: return down ? 2000 : 0;    // Z1
+  case 0x40: return down ? 1000 : 4095; // Z2
+  case 0x50: return 300 + touchY * 3400 / 240;
+  case 0x10: return 200 + touchX * 3600 / 320;
+  default: return 0;
+  }
+}
+
+// The result clocks out over the two bytes after the command byte
+static uint8_t spiOut[2];
+static int spiOutLen = 0;
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  uint8_t out = 0;
+  if (spiOutLen > 0) {
+    out = spiOut[0];
+    spiOut[0] = spiOut[1];
+    spiOutLen--;
+  }
+  if (data & 0x80) {
+    uint16_t v = touchConvert(data);
+    spiOut[0] = (v >> 5) & 0x7F;
+    spiOut[1] = (v << 3) & 0xF8;
+    spiOutLen = 2;
+  }
+  return out;
+}
+
+void SPIClass::transfer(void *data, uint32_t size) {
+  uint8_t *p = (uint8_t *)data;
+  for (uint32_t i = 0; i < size; i++)
+    p[i] = transfer(p[i]);
+}
+
+void SPIClass::transferBytes(const uint8_t *out, uint8_t *in, uint32_t size) {
+  for (uint32_t i = 0; i < size; i++) {
+    uint8_t r = transfer(out ? out[i] : 0xFF);
+    if (in)
+      in[i] = r;
+  }
+}
+
+// =============================================
+// GPIO
+// =============================================
+static uint8_t pinLevel[40];
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < sizeof(pinLevel))
+    pinLevel[pin] = val;
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin == HOST_TP_IRQ)
+    return touchDown ? LOW : HIGH;
+  return pin < sizeof(pinLevel) ? pinLevel[pin] : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+  if (pin == HOST_TP_IRQ) {
+    touchIsrMode = mode;
+    touchIsr = isr;
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin == HOST_TP_IRQ)
+    touchIsr = nullptr;
+}
+
+// =============================================
+// SERIAL (pseudo-terminal)
+// =============================================
+static int ptyFd = -1;
+static std::mutex rxMutex;
+static std::deque<uint8_t> rxBuf;
+static HardwareSerial::OnReceiveCb rxCallback = nullptr;
+static std::atomic<uint64_t> rxBytes{0}, txBytes{0};
+
+// UART receive: bytes arrive in bursts like the ESP32's RX FIFO, and
+// onReceive fires once per burst
+static void ptyReader() {
+  uint8_t buf[256];
+  for (;;) {
+    ssize_t n = ::read(ptyFd, buf, sizeof(buf));
+    if (n <= 0) {
+      // No bridge attached (EIO) or interrupted; poll again shortly
+      delay(10);
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(rxMutex);
+      rxBuf.insert(rxBuf.end(), buf, buf + n);
+    }
+    rxBytes += n;
+    hostWake(ESP_SLEEP_WAKEUP_UART);
+    if (rxCallback)
+      rxCallback();
+  }
+}
+
+static bool openPty(const char *link) {
+  ptyFd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (ptyFd < 0 || grantpt(ptyFd) < 0 || unlockpt(ptyFd) < 0)
+    return false;
+  const char *slave = ptsname(ptyFd);
+
+  struct termios tio;
+  int slaveFd = open(slave, O_RDWR | O_NOCTTY);
+  if (slaveFd < 0 || tcgetattr(slaveFd, &tio) < 0)
+    return false;
+  cfmakeraw(&tio);
+  tcsetattr(slaveFd, TCSANOW, &tio);
+  // Held open for the process lifetime so reads on the master don't
+  // fail with EIO between bridge connections (intentionally leaked)
+
+  unlink(link);
+  if (symlink(slave, link) < 0)
+    return false;
+  HOST_LOG("serial %s -> %s", link, slave);
+  return true;
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+  HOST_LOG("serial begin %lu", baud);
+  static bool started = false;
+  if (!started && ptyFd >= 0) {
+    started = true;
+    std::thread(ptyReader).detach();
+  }
+}
+
+void HardwareSerial::updateBaudRate(unsigned long baud) {
+  HOST_LOG("serial baud %lu", baud);
+}
+
+void HardwareSerial::onReceive(OnReceiveCb cb) { rxCallback = cb; }
+
+int HardwareSerial::available() {
+  std::lock_guard<std::mutex> lock(rxMutex);
+  return (int)rxBuf.size();
+}
+
+int HardwareSerial::read() {
+  std::lock_guard<std::mutex> lock(rxMutex);
+  if (rxBuf.empty())
+    return -1;
+  uint8_t c = rxBuf.front();
+  rxBuf.pop_front();
+  return c;
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t len) {
+  if (ptyFd < 0)
+    return 0;
+  size_t done = 0;
+  while (done < len) {
+    ssize_t n = ::write(ptyFd, buf + done, len - done);
+    if (n <= 0)
+      break;
+    done += n;
+  }
+  txBytes += done;
+  // Echo complete lines so commands and replies show up in the log
+  if (len > 1 && buf[0] == '{')
+    HOST_LOG("tx %.*s", (int)(buf[len - 1] == '\n' ? len - 1 : len), buf);
+  return done;
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+int HardwareSerial::printf(const char *fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n > (int)sizeof(buf) - 1)
+    n = sizeof(buf) - 1;
+  return n > 0 ? (int)write((const uint8_t *)buf, n) : n;
+}
+
+// =============================================
+// FREERTOS
+// =============================================
+// Per-task notification value
+struct HostTask {
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t notified = 0;
+};
+
+static thread_local HostTask *currentTask = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void *), const char *name,
+                                   uint32_t stack, void *arg, int prio,
+                                   TaskHandle_t *handle, int core) {
+  HOST_LOG("task %s (core %d)", name, core);
+  HostTask *task = new HostTask;
+  if (handle)
+    *handle = task;
+  std::thread([=] {
+    currentTask = task;
+    fn(arg);
+  }).detach();
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  if (!currentTask)
+    currentTask = new HostTask; // main / loop thread
+  return currentTask;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+  HostTask *task = (HostTask *)handle;
+  {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notified++;
+  }
+  task->cv.notify_one();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t *woken) {
+  xTaskNotifyGive(handle);
+  if (woken)
+    *woken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  HostTask *task = (HostTask *)xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(task->mutex);
+  auto ready = [task] { return task->notified > 0; };
+  if (ticks == portMAX_DELAY)
+    task->cv.wait(lock, ready);
+  else
+    task->cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+  uint32_t value = task->notified;
+  if (value)
+    task->notified = clear ? 0 : value - 1;
+  return value;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::timed_mutex(); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  std::timed_mutex *m = (std::timed_mutex *)sem;
+  if (ticks == portMAX_DELAY) {
+    m->lock();
+    return pdTRUE;
+  }
+  return m->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  ((std::timed_mutex *)sem)->unlock();
+  return pdTRUE;
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+void vTaskDelete(TaskHandle_t task) {
+  // Only self-deletion is used; the thread just stops doing work
+  for (;;)
+    delay(1000);
+}
+
+TickType_t xTaskGetTickCount() { return millis() / portTICK_PERIOD_MS; }
+
+// =============================================
+// LIGHT SLEEP
+// =============================================
+static std::mutex sleepMutex;
+static std::condition_variable sleepCv;
+static esp_sleep_wakeup_cause_t wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static bool sleeping = false;
+static uint64_t sleepTimerUs = 0;
+
+static void hostWake(esp_sleep_wakeup_cause_t cause) {
+  std::lock_guard<std::mutex> lock(sleepMutex);
+  if (sleeping) {
+    wakeCause = cause;
+    sleeping = false;
+    sleepCv.notify_all();
+  }
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() { return ESP_OK; }
+esp_err_t esp_sleep_enable_uart_wakeup(int uart) { return ESP_OK; }
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+  sleepTimerUs = us;
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+  unsigned long start = millis();
+  std::unique_lock<std::mutex> lock(sleepMutex);
+  if (touchDown) { // low-level wakeup source already active
+    wakeCause = ESP_SLEEP_WAKEUP_GPIO;
+    return ESP_OK;
+  }
+  sleeping = true;
+  auto awake = [] { return !sleeping; };
+  if (sleepTimerUs)
+    sleepCv.wait_for(lock, std::chrono::microseconds(sleepTimerUs), awake);
+  else
+    sleepCv.wait(lock, awake);
+  if (sleeping) {
+    sleeping = false;
+    wakeCause = ESP_SLEEP_WAKEUP_TIMER;
+  }
+  HOST_LOG("light sleep %lu ms, wake cause %d", millis() - start, wakeCause);
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return wakeCause; }
+
+// =============================================
+// FRAMEBUFFER DUMP
+// =============================================
+bool host_fb_dump_ppm(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  int w = host_fb_width(), h = host_fb_height();
+  const uint16_t *fb = host_framebuffer();
+  fprintf(f, "P6\n%d %d\n255\n", w, h);
+  for (int i = 0; i < w * h; i++) {
+    uint16_t c = fb[i];
+    uint8_t rgb[3] = {(uint8_t)((c >> 8) & 0xF8), (uint8_t)((c >> 3) & 0xFC),
+                      (uint8_t)((c << 3) & 0xF8)};
+    fwrite(rgb, 1, 3, f);
+  }
+  return fclose(f) == 0;
+}
+
+void host_panel_command(uint8_t cmd) { HOST_LOG("panel cmd 0x%02X", cmd); }
+
+// =============================================
+// TOUCH SCRIPT
+// =============================================
+// One touch per line: "<at_ms> <x> <y> [hold_ms]" ('#' starts a comment).
+// Times are relative to the end of setup().
+struct ScriptTouch {
+  unsigned long at, hold;
+  int x, y;
+};
+
+static bool loadTouchScript(const char *path, std::vector<ScriptTouch> &out) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    ScriptTouch t = {0, 100, 0, 0};
+    if (line[0] == '#')
+      continue;
+    if (sscanf(line, "%lu %d %d %lu", &t.at, &t.x, &t.y, &t.hold) >= 3)
+      out.push_back(t);
+  }
+  fclose(f);
+  return true;
+}
+
+static void touchPlayer(std::vector<ScriptTouch> script, unsigned long t0) {
+  for (const ScriptTouch &t : script) {
+    unsigned long now = millis() - t0;
+    if (t.at > now)
+      delay(t.at - now);
+    host_touch_set(true, t.x, t.y);
+    delay(t.hold);
+    host_touch_set(false, t.x, t.y);
+  }
+}
+
+// =============================================
+// MAIN
+// =============================================
+static const char *fbPath = nullptr;
+static volatile sig_atomic_t dumpRequested = 0;
+static volatile sig_atomic_t stopRequested = 0;
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--pty PATH] [--touch SCRIPT] [--fb OUT.ppm] "
+          "[--run-ms N]\n"
+          "  SIGUSR1 dumps the framebuffer to --fb while running\n",
+          argv0);
+}
+
+static void finish() {
+  if (fbPath && !host_fb_dump_ppm(fbPath))
+    HOST_LOG("cannot write %s", fbPath);
+  HOST_LOG("exit rx=%llu tx=%llu pixels=%llu",
+           (unsigned long long)rxBytes.load(),
+           (unsigned long long)txBytes.load(),
+           (unsigned long long)host_pixels_pushed());
+}
+
+int main(int argc, char **argv) {
+#ifdef HOST_BENCH
+  return host_bench_main(argc, argv);
+#endif
+  const char *ptyPath = "/tmp/ttyLCD";
+  const char *touchPath = nullptr;
+  unsigned long runMs = 0;
+
+  for (int i = 1; i < argc; i++) {
+    bool more = i + 1 < argc;
+    if (!strcmp(argv[i], "--pty") && more)
+      ptyPath = argv[++i];
+    else if (!strcmp(argv[i], "--touch") && more)
+      touchPath = argv[++i];
+    else if (!strcmp(argv[i], "--fb") && more)
+      fbPath = argv[++i];
+    else if (!strcmp(argv[i], "--run-ms") && more)
+      runMs = strtoul(argv[++i], nullptr, 10);
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  std::vector<ScriptTouch> script;
+  if (touchPath && !loadTouchScript(touchPath, script)) {
+    fprintf(stderr, "cannot read touch script %s\n", touchPath);
+    return 1;
+  }
+  if (!openPty(ptyPath)) {
+    perror("pty");
+    return 1;
+  }
+
+  signal(SIGUSR1, [](int) { dumpRequested = 1; });
+  signal(SIGINT, [](int) { stopRequested = 1; });
+  signal(SIGTERM, [](int) { stopRequested = 1; });
+
+  setup();
+  unsigned long t0 = millis();
+  HOST_LOG("setup done");
+  if (!script.empty())
+    std::thread(touchPlayer, script, t0).detach();
+
+  // loop() may never return (v2 parks it in vTaskDelete), so it gets its
+  // own thread and main just supervises
+  std::thread([] {
+    for (;;)
+      loop();
+  }).detach();
+
+  while (!stopRequested && (runMs == 0 || millis() - t0 < runMs)) {
+    if (dumpRequested && fbPath) {
+      dumpRequested = 0;
+      host_fb_dump_ppm(fbPath);
+      HOST_LOG("framebuffer -> %s", fbPath);
+    }
+    delay(10);
+  }
+
+  finish();
+  unlink(ptyPath);
+  // Firmware threads are still running; skip static destructors
+  _exit(0);
+}
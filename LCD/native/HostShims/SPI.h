@@ -0,0 +1,31 @@
+#pragma once
+
+// HOST SHIM: SPI bus. The only SPI device the firmwares drive by hand is
+// the XPT2046 touch controller, so the bus emulates one (see host.h).
+
+#include <Arduino.h>
+
+#define HSPI 2
+#define VSPI 3
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock = 1000000, uint8_t order = MSBFIRST,
+              uint8_t mode = SPI_MODE0)
+      : clock(clock) {}
+  uint32_t clock;
+};
+
+class SPIClass {
+public:
+  explicit SPIClass(uint8_t bus = HSPI) {}
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1,
+             int8_t ss = -1) {}
+  void beginTransaction(SPISettings settings) {}
+  void endTransaction() {}
+  uint8_t transfer(uint8_t data);
+  void transfer(void *data, uint32_t size);
+  void transferBytes(const uint8_t *out, uint8_t *in, uint32_t size);
+};
@@ -0,0 +1,273 @@
+#include "TFT_eSPI.h"
+
+#include "host.h"
+
+// Panel framebuffer shared with host.h; sized for either orientation
+static uint16_t fb[TFT_WIDTH * TFT_HEIGHT];
+static int16_t fbWidth = TFT_WIDTH;
+static uint64_t pixelCount = 0;
+
+const uint16_t *host_framebuffer() { return fb; }
+int host_fb_width() { return fbWidth; }
+int host_fb_height() { return (TFT_WIDTH * TFT_HEIGHT) / fbWidth; }
+uint64_t host_pixels_pushed() { return pixelCount; }
+
+static uint16_t swap16(uint16_t v) { return (v >> 8) | (v << 8); }
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
+    : _initW(w), _initH(h), _width(w), _height(h) {}
+
+void TFT_eSPI::init() { fillScreen(TFT_BLACK); }
+
+void TFT_eSPI::setRotation(uint8_t r) {
+  bool landscape = r & 1;
+  _width = landscape ? _initH : _initW;
+  _height = landscape ? _initW : _initH;
+  fbWidth = _width;
+}
+
+void TFT_eSPI::writecommand(uint8_t c) { host_panel_command(c); }
+
+void TFT_eSPI::plot(int32_t x, int32_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height)
+    return;
+  fb[y * _width + x] = color;
+  pixelCount++;
+}
+
+void TFT_eSPI::hspan(int32_t x, int32_t y, int32_t w, uint16_t color) {
+  for (int32_t i = 0; i < w; i++)
+    plot(x + i, y, color);
+}
+
+// =============================================
+// PIXEL PUSHING
+// =============================================
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+  _winX = x;
+  _winY = y;
+  _winW = w;
+  _winH = h;
+  _winPos = 0;
+}
+
+// The panel takes big-endian pixels: data straight from little-endian
+// memory only shows the right colors if it was swapped beforehand.
+void TFT_eSPI::pushColors(uint16_t *data, uint32_t len, bool swap) {
+  for (uint32_t i = 0; i < len && _winW > 0; i++, _winPos++) {
+    int32_t px = _winX + _winPos % _winW, py = _winY + _winPos / _winW;
+    plot(px, py, swap ? data[i] : swap16(data[i]));
+  }
+}
+
+void TFT_eSPI::pushPixels(const void *data, uint32_t len) {
+  pushColors((uint16_t *)data, len, _swapBytes);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                         const uint16_t *data) {
+  setAddrWindow(x, y, w, h);
+  pushColors((uint16_t *)data, (uint32_t)w * h, _swapBytes);
+}
+
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h,
+                            uint16_t *data, uint16_t *buffer) {
+  pushImage(x, y, w, h, data);
+}
+
+// =============================================
+// SPRITES
+// =============================================
+void *TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+  deleteSprite();
+  _buf = (uint16_t *)calloc((size_t)w * h, sizeof(uint16_t));
+  if (_buf) {
+    _initW = _width = w;
+    _initH = _height = h;
+  }
+  return _buf;
+}
+
+void TFT_eSprite::deleteSprite() {
+  free(_buf);
+  _buf = nullptr;
+  _width = _height = 0;
+}
+
+void TFT_eSprite::plot(int32_t x, int32_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height)
+    return;
+  _buf[y * _width + x] = color;
+}
+
+bool TFT_eSprite::pushSprite(int32_t x, int32_t y, int32_t sx, int32_t sy,
+                             int32_t sw, int32_t sh) {
+  if (!_buf || sx < 0 || sy < 0 || sw <= 0 || sh <= 0 ||
+      sx + sw > _width || sy + sh > _height)
+    return false;
+  _tft->setAddrWindow(x, y, sw, sh);
+  for (int32_t j = 0; j < sh; j++)
+    _tft->pushColors(_buf + (sy + j) * _width + sx, sw, true);
+  return true;
+}
+
+// =============================================
+// SHAPES
+// =============================================
+void TFT_eSPI::fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  plot(x, y, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                        uint32_t color) {
+  for (int32_t j = 0; j < h; j++)
+    hspan(x, y + j, w, color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                        uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+// Horizontal inset of row j (0 = top) for a corner of radius r
+static int32_t cornerInset(int32_t j, int32_t r) {
+  int32_t dy = r - j;
+  if (dy <= 0)
+    return 0;
+  return r - (int32_t)sqrtf((float)(r * r - dy * dy));
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                             int32_t r, uint32_t color) {
+  r = min(r, min(w, h) / 2);
+  for (int32_t j = 0; j < h; j++) {
+    int32_t in = cornerInset(min(j, h - 1 - j), r);
+    hspan(x + in, y + j, w - 2 * in, color);
+  }
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                             int32_t r, uint32_t color) {
+  r = min(r, min(w, h) / 2);
+  for (int32_t j = 0; j < h; j++) {
+    int32_t in = cornerInset(min(j, h - 1 - j), r);
+    if (j == 0 || j == h - 1) {
+      hspan(x + in, y + j, w - 2 * in, color);
+    } else {
+      plot(x + in, y + j, color);
+      plot(x + w - 1 - in, y + j, color);
+    }
+  }
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  hspan(x, y, w, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  for (int32_t j = 0; j < h; j++)
+    plot(x, y + j, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                        uint32_t color) {
+  int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+  for (;;) {
+    plot(x0, y0, color);
+    if (x0 == x1 && y0 == y1)
+      break;
+    int32_t e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void TFT_eSPI::drawCircle(int32_t cx, int32_t cy, int32_t r, uint32_t color) {
+  for (int32_t dy = -r; dy <= r; dy++) {
+    int32_t dx = (int32_t)sqrtf((float)(r * r - dy * dy));
+    plot(cx - dx, cy + dy, color);
+    plot(cx + dx, cy + dy, color);
+  }
+}
+
+void TFT_eSPI::fillCircle(int32_t cx, int32_t cy, int32_t r, uint32_t color) {
+  for (int32_t dy = -r; dy <= r; dy++) {
+    int32_t dx = (int32_t)sqrtf((float)(r * r - dy * dy));
+    hspan(cx - dx, cy + dy, 2 * dx + 1, color);
+  }
+}
+
+// =============================================
+// TEXT
+// =============================================
+// Average advance / height of the built-in fonts (GLCD, Font 2, Font 4)
+int16_t TFT_eSPI::charWidth() const {
+  switch (_font) {
+  case 2: return 8 * _size;
+  case 4: return 14 * _size;
+  default: return 6 * _size;
+  }
+}
+
+int16_t TFT_eSPI::fontHeight() {
+  switch (_font) {
+  case 2: return 16 * _size;
+  case 4: return 26 * _size;
+  default: return 8 * _size;
+  }
+}
+
+int16_t TFT_eSPI::textWidth(const char *s) {
+  return (int16_t)strlen(s) * charWidth();
+}
+
+size_t TFT_eSPI::print(const char *s) {
+  int16_t cw = charWidth(), h = fontHeight();
+  for (const char *p = s; *p; p++) {
+    if (*p == '\n') {
+      _cx = 0;
+      _cy += h;
+      continue;
+    }
+    if (_bg != _fg)
+      fillRect(_cx, _cy, cw, h, _bg);
+    if (*p != ' ')
+      fillRect(_cx + 1, _cy + h / 4, cw - 2, h / 2, _fg);
+    _cx += cw;
+  }
+  return strlen(s);
+}
+
+size_t TFT_eSPI::print(int v) {
+  char buf[12];
+  snprintf(buf, sizeof(buf), "%d", v);
+  return print(buf);
+}
+
+size_t TFT_eSPI::println(const char *s) {
+  size_t n = print(s);
+  _cx = 0;
+  _cy += fontHeight();
+  return n + 1;
+}
+
+int16_t TFT_eSPI::drawString(const char *s, int32_t x, int32_t y) {
+  int16_t w = textWidth(s), h = fontHeight();
+  _cx = x - (_datum % 3) * w / 2;
+  _cy = y - (_datum / 3) * h / 2;
+  print(s);
+  return w;
+}
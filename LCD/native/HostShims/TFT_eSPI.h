@@ -0,0 +1,144 @@
+#pragma once
+
+// HOST SHIM: TFT_eSPI drawing into an in-memory RGB565 framebuffer.
+// Shapes are exact; text is drawn as one block per glyph with the
+// metrics of the real fonts, which is enough to see layout and damage.
+
+#include <Arduino.h>
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_BLUE 0x001F
+#define TFT_CYAN 0x07FF
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_ORANGE 0xFDA0
+#define TFT_WHITE 0xFFFF
+
+// Panel commands (writecommand)
+#define TFT_SLPIN 0x10
+#define TFT_SLPOUT 0x11
+
+// Text datums (drawString reference point)
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+
+class TFT_eSPI {
+public:
+  TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+  virtual ~TFT_eSPI() {}
+
+  void init();
+  void begin() { init(); }
+  void setRotation(uint8_t r);
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  // Bus / DMA: transfers complete synchronously on the host
+  void startWrite() {}
+  void endWrite() {}
+  bool initDMA(bool ctrl_cs = false) { return true; }
+  bool dmaBusy() { return false; }
+  void dmaWait() {}
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  bool getSwapBytes() const { return _swapBytes; }
+  void writecommand(uint8_t c);
+
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+  void pushColors(uint16_t *data, uint32_t len, bool swap = true);
+  void pushPixels(const void *data, uint32_t len);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                 const uint16_t *data);
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h,
+                    uint16_t *data, uint16_t *buffer = nullptr);
+
+  void fillScreen(uint32_t color);
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r,
+                     uint32_t color);
+  void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r,
+                     uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                uint32_t color);
+  void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+  void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+
+  // Text
+  void setTextFont(uint8_t font) { _font = font; }
+  void setTextSize(uint8_t size) { _size = size ? size : 1; }
+  void setTextColor(uint16_t c) { _fg = _bg = c; }
+  void setTextColor(uint16_t c, uint16_t bg) {
+    _fg = c;
+    _bg = bg;
+  }
+  void setTextDatum(uint8_t d) { _datum = d; }
+  void setCursor(int16_t x, int16_t y) {
+    _cx = x;
+    _cy = y;
+  }
+  int16_t textWidth(const char *s);
+  int16_t fontHeight();
+  int16_t drawString(const char *s, int32_t x, int32_t y);
+  size_t print(const char *s);
+  size_t print(int v);
+  size_t println(const char *s = "");
+
+protected:
+  // Every pixel write funnels through here; overridden by TFT_eSprite
+  virtual void plot(int32_t x, int32_t y, uint16_t color);
+  void hspan(int32_t x, int32_t y, int32_t w, uint16_t color);
+  int16_t charWidth() const;
+
+  int16_t _initW, _initH, _width, _height;
+  bool _swapBytes = false;
+  uint8_t _font = 1, _size = 1, _datum = TL_DATUM;
+  uint16_t _fg = TFT_WHITE, _bg = TFT_WHITE;
+  int16_t _cx = 0, _cy = 0;
+  int32_t _winX = 0, _winY = 0, _winW = 0, _winH = 0, _winPos = 0;
+};
+
+// HOST SHIM: 16 bpp sprite. Pixels are kept in true colors and reach the
+// panel only through pushSprite(), which counts them as panel writes.
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI *tft) : TFT_eSPI(0, 0), _tft(tft) {}
+  ~TFT_eSprite() { deleteSprite(); }
+
+  void *createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite();
+  bool created() const { return _buf != nullptr; }
+  void *setColorDepth(int8_t bits) { return _buf; } // 16 bpp only
+  void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+
+  void pushSprite(int32_t x, int32_t y) {
+    pushSprite(x, y, 0, 0, _width, _height);
+  }
+  // Push the sw x sh window at (sx, sy) of the sprite to (x, y)
+  bool pushSprite(int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t sw,
+                  int32_t sh);
+
+protected:
+  void plot(int32_t x, int32_t y, uint16_t color) override;
+
+private:
+  TFT_eSPI *_tft;
+  uint16_t *_buf = nullptr;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+// HOST SHIM: ESP-IDF GPIO driver (wakeup / interrupt type only)
+
+typedef int gpio_num_t;
+typedef int esp_err_t;
+
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef enum {
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_NEGEDGE,
+  GPIO_INTR_ANYEDGE,
+  GPIO_INTR_LOW_LEVEL,
+  GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+inline esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+  return ESP_OK;
+}
+inline esp_err_t gpio_wakeup_disable(gpio_num_t pin) { return ESP_OK; }
+inline esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+  return ESP_OK;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// HOST SHIM: ESP-IDF UART driver (light-sleep wakeup only)
+
+#include <driver/gpio.h>
+
+typedef int uart_port_t;
+#define UART_NUM_0 0
+
+inline esp_err_t uart_set_wakeup_threshold(uart_port_t uart, int edges) {
+  return ESP_OK;
+}
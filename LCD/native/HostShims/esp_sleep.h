@@ -0,0 +1,21 @@
+#pragma once
+
+// HOST SHIM: light sleep. esp_light_sleep_start() blocks the calling
+// thread until a touch or serial bytes arrive; the timer source is
+// honoured as a timeout.
+
+#include <driver/gpio.h>
+#include <stdint.h>
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+  ESP_SLEEP_WAKEUP_TIMER = 4,
+  ESP_SLEEP_WAKEUP_GPIO = 7,
+  ESP_SLEEP_WAKEUP_UART = 8,
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_gpio_wakeup();
+esp_err_t esp_sleep_enable_uart_wakeup(int uart);
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us);
+esp_err_t esp_light_sleep_start();
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
@@ -0,0 +1,32 @@
+#pragma once
+
+// =============================================
+// EMULATOR-ONLY API
+// =============================================
+// Hooks for code that knows it runs under the Linux emulator (benchmarks,
+// render harnesses). Firmware sources never include this.
+
+#include <stdint.h>
+
+// Panel framebuffer, RGB565 in true (unswapped) colors, row-major at the
+// current rotation's width x height
+const uint16_t *host_framebuffer();
+int host_fb_width();
+int host_fb_height();
+
+// Pixels written to the panel since start, for damage/throughput stats
+uint64_t host_pixels_pushed();
+
+// Write the framebuffer as a binary PPM; false on I/O error
+bool host_fb_dump_ppm(const char *path);
+
+// Raw command bytes sent to the panel (writecommand), logged to stderr
+void host_panel_command(uint8_t cmd);
+
+// Press (x, y in screen coordinates) or release the emulated touch panel
+void host_touch_set(bool pressed, int x, int y);
+
+// Benchmark and render harness builds (-D HOST_BENCH) define this; main()
+// then runs it in place of the emulator: no pty, setup() and loop() are up
+// to it
+int host_bench_main(int argc, char **argv);